@@ -0,0 +1,312 @@
+# =============================================================================
+# Toolchain Benchmark across Configure Presets (script mode)
+# =============================================================================
+# Usage (normally through the toolchain_benchmark target):
+#   cmake [-DSOURCE_DIR=<project>] [-DWORK_DIR=<dir>] [-DOUTPUT=<file.json>]
+#         [-DPRESETS=<preset|preset|...>] [-DTARGETS=<target|target|...>]
+#         [-DCONFIGURE_ARGS=<arg|arg|...>] [-DLTO_BITCODE=<OFF|ON>] [-DJOBS=<n>]
+#         [-DTOUCH_HEADER=<file>] [-DTOUCH_SOURCE=<file>]
+#         [-DBASELINE=<previous .json>]
+#         -P MSVC_Benchmark.cmake
+#
+# Every configure preset (default: all presets listed by
+# cmake --list-presets) is run once per ENABLE_LTO_BITCODE value in
+# LTO_BITCODE (default: OFF|ON). Each run is keyed <preset> (OFF) or
+# <preset>-lto (ON), gets a fresh build tree <WORK_DIR>/<key> and the
+# following steps are timed:
+#
+#   configure_ms              cmake --preset <preset> -B <WORK_DIR>/<key>
+#                             -DENABLE_LTO_BITCODE=<OFF|ON>
+#   cold_build_ms             First full build
+#   noop_build_ms             Build again without changes
+#   header_touch_build_ms     Build after touching TOUCH_HEADER
+#   source_touch_build_ms     Build after touching TOUCH_SOURCE
+#
+# The default build covers all example/ targets, standard and _lto variants;
+# test_lib and test_dll only go through the bitcode path in the -lto runs.
+# The size of every .exe / .dll / .sys in the build tree is recorded as well.
+# The JSON written to OUTPUT has a fixed key order, so results of two commits
+# can be compared with a plain diff, or by passing the older file as BASELINE.
+# Output of each step is kept in <WORK_DIR>/<key>-logs.
+# =============================================================================
+
+cmake_minimum_required(VERSION 3.23) # string(TIMESTAMP %f)
+
+# Run from a make / ninja recipe: do not hand the outer job server down
+unset(ENV{MAKEFLAGS})
+unset(ENV{MFLAGS})
+unset(ENV{MAKELEVEL})
+
+if(NOT SOURCE_DIR)
+    get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+endif()
+if(NOT WORK_DIR)
+    set(WORK_DIR "${SOURCE_DIR}/build-benchmark")
+endif()
+if(NOT OUTPUT)
+    set(OUTPUT "${WORK_DIR}/benchmark.json")
+endif()
+if(NOT TOUCH_HEADER)
+    set(TOUCH_HEADER "example/test_lib/stringlib.h")
+endif()
+if(NOT TOUCH_SOURCE)
+    set(TOUCH_SOURCE "example/test_exe/helper.cpp")
+endif()
+if(NOT DEFINED LTO_BITCODE)
+    set(LTO_BITCODE "OFF|ON")
+endif()
+if(NOT JOBS)
+    cmake_host_system_information(RESULT JOBS QUERY NUMBER_OF_LOGICAL_CORES)
+endif()
+
+# Lists are passed with '|' separators
+foreach(_var PRESETS TARGETS CONFIGURE_ARGS LTO_BITCODE)
+    string(REPLACE "|" ";" ${_var} "${${_var}}")
+endforeach()
+
+foreach(_file TOUCH_HEADER TOUCH_SOURCE)
+    if(NOT EXISTS "${SOURCE_DIR}/${${_file}}")
+        message(FATAL_ERROR "[MSVC-Benchmark] ${_file} not found: ${SOURCE_DIR}/${${_file}}")
+    endif()
+endforeach()
+
+# All configure presets of the project
+if(NOT PRESETS)
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} --list-presets=configure
+        WORKING_DIRECTORY "${SOURCE_DIR}"
+        OUTPUT_VARIABLE _preset_list
+        RESULT_VARIABLE _result
+    )
+    if(NOT _result EQUAL 0)
+        message(FATAL_ERROR "[MSVC-Benchmark] cmake --list-presets failed in ${SOURCE_DIR}")
+    endif()
+
+    string(REGEX MATCHALL "\n  \"[^\"]+\"" _preset_lines "${_preset_list}")
+    foreach(_line ${_preset_lines})
+        string(REGEX REPLACE "^\n  \"([^\"]+)\"$" "\\1" _preset "${_line}")
+        list(APPEND PRESETS "${_preset}")
+    endforeach()
+endif()
+
+if(NOT PRESETS)
+    message(FATAL_ERROR "[MSVC-Benchmark] No configure presets found in ${SOURCE_DIR}")
+endif()
+if(NOT LTO_BITCODE)
+    message(FATAL_ERROR "[MSVC-Benchmark] LTO_BITCODE must list OFF and/or ON")
+endif()
+
+# Current time in microseconds
+function(_bench_now output_var)
+    string(TIMESTAMP _now "%s%f" UTC)
+    set(${output_var} "${_now}" PARENT_SCOPE)
+endfunction()
+
+# Run a command and measure its wall time
+#
+# Parameters:
+#   log_file: File receiving the output of the command
+#   ms_var: [Output] Wall time in milliseconds
+#   ok_var: [Output] TRUE if the command succeeded
+#   ARGN: Command line
+#
+function(_bench_run log_file ms_var ok_var)
+    _bench_now(_start)
+    execute_process(
+        COMMAND ${ARGN}
+        WORKING_DIRECTORY "${SOURCE_DIR}"
+        RESULT_VARIABLE _result
+        OUTPUT_VARIABLE _output
+        ERROR_VARIABLE _output
+    )
+    _bench_now(_end)
+
+    file(WRITE "${log_file}" "${_output}")
+    math(EXPR _ms "(${_end} - ${_start}) / 1000")
+    set(${ms_var} "${_ms}" PARENT_SCOPE)
+
+    if(_result EQUAL 0)
+        set(${ok_var} TRUE PARENT_SCOPE)
+    else()
+        string(JOIN " " _command_line ${ARGN})
+        message(WARNING "[MSVC-Benchmark] Command failed (${_result}), see ${log_file}:\n  ${_command_line}")
+        set(${ok_var} FALSE PARENT_SCOPE)
+    endif()
+endfunction()
+
+function(_bench_json_escape value output_var)
+    string(REPLACE "\\" "\\\\" value "${value}")
+    string(REPLACE "\"" "\\\"" value "${value}")
+    set(${output_var} "${value}" PARENT_SCOPE)
+endfunction()
+
+# -----------------------------------------------------------------------------
+# Run
+# -----------------------------------------------------------------------------
+
+set(_build_args --parallel ${JOBS})
+foreach(_target ${TARGETS})
+    list(APPEND _build_args --target ${_target})
+endforeach()
+
+set(_steps configure_ms cold_build_ms noop_build_ms header_touch_build_ms source_touch_build_ms)
+set(_runs "")
+set(_failed_runs "")
+set(_preset_json "")
+
+foreach(_preset ${PRESETS})
+    foreach(_lto ${LTO_BITCODE})
+        if(_lto)
+            set(_run "${_preset}-lto")
+        else()
+            set(_run "${_preset}")
+        endif()
+        list(APPEND _runs "${_run}")
+
+        set(_binary_dir "${WORK_DIR}/${_run}")
+        set(_log_dir "${WORK_DIR}/${_run}-logs")
+        file(REMOVE_RECURSE "${_binary_dir}" "${_log_dir}")
+        file(MAKE_DIRECTORY "${_log_dir}")
+
+        message(STATUS "[MSVC-Benchmark] ${_run}: ${_binary_dir}")
+        foreach(_step ${_steps})
+            set(_${_step} "null")
+        endforeach()
+
+        _bench_run("${_log_dir}/configure.log" _ms _ok
+            ${CMAKE_COMMAND} --preset ${_preset} -B "${_binary_dir}" ${CONFIGURE_ARGS}
+            -DENABLE_LTO_BITCODE=${_lto})
+        set(_configure_ms ${_ms})
+
+        if(_ok)
+            _bench_run("${_log_dir}/cold_build.log" _ms _ok
+                ${CMAKE_COMMAND} --build "${_binary_dir}" ${_build_args})
+            set(_cold_build_ms ${_ms})
+        endif()
+
+        if(_ok)
+            _bench_run("${_log_dir}/noop_build.log" _ms _ok
+                ${CMAKE_COMMAND} --build "${_binary_dir}" ${_build_args})
+            set(_noop_build_ms ${_ms})
+        endif()
+
+        if(_ok)
+            file(TOUCH "${SOURCE_DIR}/${TOUCH_HEADER}")
+            _bench_run("${_log_dir}/header_touch_build.log" _ms _ok
+                ${CMAKE_COMMAND} --build "${_binary_dir}" ${_build_args})
+            set(_header_touch_build_ms ${_ms})
+        endif()
+
+        if(_ok)
+            file(TOUCH "${SOURCE_DIR}/${TOUCH_SOURCE}")
+            _bench_run("${_log_dir}/source_touch_build.log" _ms _ok
+                ${CMAKE_COMMAND} --build "${_binary_dir}" ${_build_args})
+            set(_source_touch_build_ms ${_ms})
+        endif()
+
+        if(NOT _ok)
+            list(APPEND _failed_runs "${_run}")
+        endif()
+
+        # Output sizes (compiler checks under CMakeFiles are skipped)
+        file(GLOB_RECURSE _outputs RELATIVE "${_binary_dir}"
+            "${_binary_dir}/*.exe" "${_binary_dir}/*.dll" "${_binary_dir}/*.sys")
+        list(FILTER _outputs EXCLUDE REGEX "(^|/)CMakeFiles/")
+        list(SORT _outputs)
+
+        _bench_json_escape("${_run}" _run_escaped)
+        string(APPEND _preset_json "    \"${_run_escaped}\": {\n")
+        if(_ok)
+            string(APPEND _preset_json "      \"status\": \"ok\",\n")
+        else()
+            string(APPEND _preset_json "      \"status\": \"failed\",\n")
+        endif()
+        foreach(_step ${_steps})
+            string(APPEND _preset_json "      \"${_step}\": ${_${_step}},\n")
+        endforeach()
+
+        set(_sizes_json "")
+        foreach(_output ${_outputs})
+            file(SIZE "${_binary_dir}/${_output}" _size)
+            _bench_json_escape("${_output}" _output_escaped)
+            list(APPEND _sizes_json "        \"${_output_escaped}\": ${_size}")
+        endforeach()
+        if(_sizes_json)
+            string(JOIN ",\n" _sizes_json ${_sizes_json})
+            string(APPEND _preset_json "      \"output_bytes\": {\n${_sizes_json}\n      }\n")
+        else()
+            string(APPEND _preset_json "      \"output_bytes\": {}\n")
+        endif()
+        string(APPEND _preset_json "    },\n")
+    endforeach()
+endforeach()
+string(REGEX REPLACE ",\n$" "\n" _preset_json "${_preset_json}")
+
+# -----------------------------------------------------------------------------
+# Report
+# -----------------------------------------------------------------------------
+
+execute_process(
+    COMMAND git rev-parse HEAD
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE _commit
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+string(TIMESTAMP _date "%Y-%m-%dT%H:%M:%SZ" UTC)
+_bench_json_escape("${TOUCH_HEADER}" _header_escaped)
+_bench_json_escape("${TOUCH_SOURCE}" _source_escaped)
+
+file(WRITE "${OUTPUT}"
+    "{\n"
+    "  \"commit\": \"${_commit}\",\n"
+    "  \"date\": \"${_date}\",\n"
+    "  \"host\": \"${CMAKE_HOST_SYSTEM_NAME}\",\n"
+    "  \"cmake_version\": \"${CMAKE_VERSION}\",\n"
+    "  \"jobs\": ${JOBS},\n"
+    "  \"touch_header\": \"${_header_escaped}\",\n"
+    "  \"touch_source\": \"${_source_escaped}\",\n"
+    "  \"presets\": {\n"
+    "${_preset_json}"
+    "  }\n"
+    "}\n"
+)
+message(STATUS "[MSVC-Benchmark] Results written to ${OUTPUT}")
+
+# Compare with an earlier run
+if(BASELINE)
+    file(READ "${BASELINE}" _baseline)
+    file(READ "${OUTPUT}" _current)
+
+    foreach(_run ${_runs})
+        string(JSON _keys ERROR_VARIABLE _error LENGTH "${_baseline}" presets "${_run}")
+        if(_error)
+            message(STATUS "[MSVC-Benchmark] ${_run}: not in baseline")
+            continue()
+        endif()
+
+        foreach(_step ${_steps})
+            string(JSON _old ERROR_VARIABLE _error GET "${_baseline}" presets "${_run}" ${_step})
+            string(JSON _new ERROR_VARIABLE _error_new GET "${_current}" presets "${_run}" ${_step})
+            # Skipped steps are null
+            if(_error OR _error_new OR NOT _old MATCHES "^[0-9]+$" OR NOT _new MATCHES "^[0-9]+$" OR _old EQUAL 0)
+                continue()
+            endif()
+            # Format the change from its magnitude, the sign is added separately
+            math(EXPR _permille "(${_new} - ${_old}) * 1000 / ${_old}")
+            set(_sign "")
+            if(_permille LESS 0)
+                set(_sign "-")
+                math(EXPR _permille "-(${_permille})")
+            endif()
+            math(EXPR _whole "${_permille} / 10")
+            math(EXPR _tenth "${_permille} % 10")
+            message(STATUS "[MSVC-Benchmark] ${_run} ${_step}: ${_old} -> ${_new} (${_sign}${_whole}.${_tenth}%)")
+        endforeach()
+    endforeach()
+endif()
+
+if(_failed_runs)
+    string(JOIN ", " _failed_runs ${_failed_runs})
+    message(SEND_ERROR "[MSVC-Benchmark] Failed runs: ${_failed_runs}")
+endif()
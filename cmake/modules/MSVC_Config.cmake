@@ -18,6 +18,7 @@ list(APPEND CMAKE_TRY_COMPILE_PLATFORM_VARIABLES
     WDKBASE
     MSVCBASE
     WDKVERSION
+    MSVC_SYSROOT
 )
 
 # =============================================================================
@@ -104,4 +105,31 @@ set(WDK_INCLUDE_KMDF "${WDKBASE}/Include/wdf/kmdf/1.15")
 
 set(WDK_LIB_UM "${WDKBASE}/Lib/${WDKVERSION}/um/x64")
 set(WDK_LIB_UCRT "${WDKBASE}/Lib/${WDKVERSION}/ucrt/x64")
-set(WDK_LIB_KM "${WDKBASE}/Lib/${WDKVERSION}/km/x64")
\ No newline at end of file
+set(WDK_LIB_KM "${WDKBASE}/Lib/${WDKVERSION}/km/x64")
+
+# Search order of the include and library directories
+# (replaced by MSVC_Sysroot when a packed sysroot is used)
+set(MSVC_USER_MODE_INCLUDE_DIRS
+    "${MSVC_INCLUDE}"
+    "${WDK_INCLUDE_UCRT}"
+    "${WDK_INCLUDE_SHARED}"
+    "${WDK_INCLUDE_UM}"
+)
+
+set(MSVC_KERNEL_MODE_INCLUDE_DIRS
+    "${WDK_INCLUDE_KM}"
+    "${WDK_INCLUDE_KMDF}"
+    "${WDK_INCLUDE_SHARED}"
+    "${WDK_INCLUDE_UCRT}"
+    "${MSVC_INCLUDE}"
+)
+
+set(MSVC_USER_MODE_LIB_DIRS
+    "${MSVC_LIB}"
+    "${WDK_LIB_UCRT}"
+    "${WDK_LIB_UM}"
+)
+
+set(MSVC_KERNEL_MODE_LIB_DIRS
+    "${WDK_LIB_KM}"
+)
\ No newline at end of file
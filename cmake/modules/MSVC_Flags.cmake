@@ -8,53 +8,30 @@
 
 # A) LTO / Custom Command Version (Clean List, No SHELL prefix)
 # Used when manually constructing command lines for custom commands
-set(MSVC_USER_MODE_INCLUDES_LTO
-    "-imsvc" "${MSVC_INCLUDE}"
-    "-imsvc" "${WDK_INCLUDE_UCRT}"
-    "-imsvc" "${WDK_INCLUDE_SHARED}"
-    "-imsvc" "${WDK_INCLUDE_UM}"
-)
-
-set(MSVC_KERNEL_MODE_INCLUDES_LTO
-    "-imsvc" "${WDK_INCLUDE_KM}"
-    "-imsvc" "${WDK_INCLUDE_KMDF}"
-    "-imsvc" "${WDK_INCLUDE_SHARED}"
-    "-imsvc" "${WDK_INCLUDE_UCRT}"
-    "-imsvc" "${MSVC_INCLUDE}"
-)
-
 # B) Standard Target Version (SHELL prefix)
 # Used with target_compile_options to prevent argument de-duplication
-set(MSVC_USER_MODE_INCLUDES
-    "SHELL:-imsvc \"${MSVC_INCLUDE}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_UCRT}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_SHARED}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_UM}\""
-)
-
-set(MSVC_KERNEL_MODE_INCLUDES
-    "SHELL:-imsvc \"${WDK_INCLUDE_KM}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_KMDF}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_SHARED}\""
-    "SHELL:-imsvc \"${WDK_INCLUDE_UCRT}\""
-    "SHELL:-imsvc \"${MSVC_INCLUDE}\""
-)
+set(MSVC_USER_MODE_INCLUDES_LTO "")
+set(MSVC_USER_MODE_INCLUDES "")
+foreach(_dir ${MSVC_USER_MODE_INCLUDE_DIRS})
+    list(APPEND MSVC_USER_MODE_INCLUDES_LTO "-imsvc" "${_dir}")
+    list(APPEND MSVC_USER_MODE_INCLUDES "SHELL:-imsvc \"${_dir}\"")
+endforeach()
+
+set(MSVC_KERNEL_MODE_INCLUDES_LTO "")
+set(MSVC_KERNEL_MODE_INCLUDES "")
+foreach(_dir ${MSVC_KERNEL_MODE_INCLUDE_DIRS})
+    list(APPEND MSVC_KERNEL_MODE_INCLUDES_LTO "-imsvc" "${_dir}")
+    list(APPEND MSVC_KERNEL_MODE_INCLUDES "SHELL:-imsvc \"${_dir}\"")
+endforeach()
 
 # -----------------------------------------------------------------------------
 # 2. Setup Include Strings (Quoted for CMAKE_XXX_FLAGS_INIT)
 # -----------------------------------------------------------------------------
 
-set(_msvc_inc_q "/imsvc\"${MSVC_INCLUDE}\"")
-set(_ucrt_inc_q "/imsvc\"${WDK_INCLUDE_UCRT}\"")
-set(_shared_inc_q "/imsvc\"${WDK_INCLUDE_SHARED}\"")
-set(_um_inc_q "/imsvc\"${WDK_INCLUDE_UM}\"")
-
-set(_user_mode_inc_list
-    "${_msvc_inc_q}"
-    "${_ucrt_inc_q}"
-    "${_shared_inc_q}"
-    "${_um_inc_q}"
-)
+set(_user_mode_inc_list "")
+foreach(_dir ${MSVC_USER_MODE_INCLUDE_DIRS})
+    list(APPEND _user_mode_inc_list "/imsvc\"${_dir}\"")
+endforeach()
 string(JOIN " " _user_mode_include_str ${_user_mode_inc_list})
 
 # -----------------------------------------------------------------------------
@@ -68,16 +45,20 @@ string(JOIN " " _user_mode_include_str ${_user_mode_inc_list})
 set(MSVC_COMMON_COMPILE_FLAGS_LTO
     --target=x86_64-pc-windows-msvc
     -Wno-msvc-not-found
-    "-Xclang" "-ivfsoverlay" "-Xclang" "${VFSOVERLAY_FILE}"
 )
 
 # Standard Version (SHELL prefix)
 set(MSVC_COMMON_COMPILE_FLAGS
     --target=x86_64-pc-windows-msvc
     -Wno-msvc-not-found
-    "SHELL:-Xclang -ivfsoverlay -Xclang \"${VFSOVERLAY_FILE}\""
 )
 
+# No overlay is needed with a packed (case-normalized) sysroot
+if(VFSOVERLAY_FILE)
+    list(APPEND MSVC_COMMON_COMPILE_FLAGS_LTO "-Xclang" "-ivfsoverlay" "-Xclang" "${VFSOVERLAY_FILE}")
+    list(APPEND MSVC_COMMON_COMPILE_FLAGS "SHELL:-Xclang -ivfsoverlay -Xclang \"${VFSOVERLAY_FILE}\"")
+endif()
+
 # Initialize standard CMake flags
 set(CMAKE_C_FLAGS_INIT "--target=x86_64-pc-windows-msvc ${_user_mode_include_str} -Wno-msvc-not-found")
 set(CMAKE_CXX_FLAGS_INIT "--target=x86_64-pc-windows-msvc ${_user_mode_include_str} -Wno-msvc-not-found")
@@ -86,24 +67,20 @@ set(CMAKE_CXX_FLAGS_INIT "--target=x86_64-pc-windows-msvc ${_user_mode_include_s
 # 4. Linker Flags
 # -----------------------------------------------------------------------------
 # Similarly for Lib Paths
-set(MSVC_USER_MODE_LINK_PATHS
-    "/LIBPATH:${MSVC_LIB}"
-    "/LIBPATH:${WDK_LIB_UCRT}"
-    "/LIBPATH:${WDK_LIB_UM}"
-)
-
-set(MSVC_KERNEL_MODE_LINK_PATHS
-    "/LIBPATH:${WDK_LIB_KM}"
-)
-
-# Helper for INIT strings (quoted)
-set(_msvc_lib_q "\"/LIBPATH:${MSVC_LIB}\"")
-set(_ucrt_lib_q "\"/LIBPATH:${WDK_LIB_UCRT}\"")
-set(_um_lib_q "\"/LIBPATH:${WDK_LIB_UM}\"")
-
-set(_user_mode_link_list "${_msvc_lib_q}" "${_ucrt_lib_q}" "${_um_lib_q}")
+set(MSVC_USER_MODE_LINK_PATHS "")
+set(_user_mode_link_list "")
+foreach(_dir ${MSVC_USER_MODE_LIB_DIRS})
+    list(APPEND MSVC_USER_MODE_LINK_PATHS "/LIBPATH:${_dir}")
+    # Helper for INIT strings (quoted)
+    list(APPEND _user_mode_link_list "\"/LIBPATH:${_dir}\"")
+endforeach()
 string(JOIN " " _user_mode_link_str ${_user_mode_link_list})
 
+set(MSVC_KERNEL_MODE_LINK_PATHS "")
+foreach(_dir ${MSVC_KERNEL_MODE_LIB_DIRS})
+    list(APPEND MSVC_KERNEL_MODE_LINK_PATHS "/LIBPATH:${_dir}")
+endforeach()
+
 # Initialize standard CMake linker flags
 set(CMAKE_EXE_LINKER_FLAGS_INIT "${_user_mode_link_str}")
 set(CMAKE_SHARED_LINKER_FLAGS_INIT "${_user_mode_link_str}")
@@ -134,6 +111,14 @@ set(MSVC_KERNEL_MODE_LINK_OPTIONS
     "/SUBSYSTEM:NATIVE"
     "/ENTRY:DriverEntry"
     "/NODEFAULTLIB"
+    "/OPT:REF"
+)
+
+# llc equivalent of /Gy (plus data sections) for LTO drivers, so /OPT:REF can
+# strip unreferenced code and data
+set(MSVC_KERNEL_MODE_LLC_FLAGS
+    -function-sections
+    -data-sections
 )
 
 set(MSVC_KERNEL_MODE_LIBS
@@ -8,6 +8,9 @@ option(ENABLE_LTO_BITCODE "Compile C/C++ sources to LLVM bitcode for LTO" OFF)
 # Default optimization passes for opt
 set(LTO_OPT_PASSES "-O2" CACHE STRING "Optimization passes for opt command")
 
+# Directory of this module (for script-mode helpers)
+set(MSVC_LTO_MODULE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
 # Helper macro to check LTO availability
 macro(_check_lto_available)
     if(NOT LTO_TOOLS_AVAILABLE)
@@ -29,6 +32,103 @@ function(_get_source_type source_file result_var)
     endif()
 endfunction()
 
+# Escape a string for use inside a JSON string literal
+function(_lto_json_escape input output_var)
+    string(REPLACE "\\" "\\\\" _escaped "${input}")
+    string(REPLACE "\"" "\\\"" _escaped "${_escaped}")
+    set(${output_var} "${_escaped}" PARENT_SCOPE)
+endfunction()
+
+# Record a bitcode compile for compile_commands.json
+#
+# Custom commands are not exported by CMake, so LTO compiles are collected in
+# the LTO_COMPILE_COMMANDS global property and written to
+# compile_commands_lto.json at the end of the configure step (see
+# _lto_write_compile_commands).
+#
+# Parameters:
+#   source_file: Absolute path of the source file
+#   output_file: Path of the generated bitcode file
+#   ARGN: The exact compiler command line; the usage requirements of the
+#         target are passed as @<target>.lto_flags.rsp, which the merge
+#         expands into separate arguments
+#
+function(_lto_record_compile_command source_file output_file)
+    if(NOT CMAKE_EXPORT_COMPILE_COMMANDS)
+        return()
+    endif()
+
+    set(_args "")
+    foreach(_arg ${ARGN})
+        _lto_json_escape("${_arg}" _escaped)
+        list(APPEND _args "\"${_escaped}\"")
+    endforeach()
+    string(JOIN ", " _args_str ${_args})
+
+    _lto_json_escape("${CMAKE_CURRENT_BINARY_DIR}" _directory)
+    _lto_json_escape("${source_file}" _file)
+    _lto_json_escape("${output_file}" _output)
+
+    set(_entry "{\n  \"directory\": \"${_directory}\",\n  \"arguments\": [${_args_str}],\n  \"file\": \"${_file}\",\n  \"output\": \"${_output}\"\n}")
+    set_property(GLOBAL APPEND PROPERTY LTO_COMPILE_COMMANDS "${_entry}")
+
+    # Write the database once all directories have been processed
+    get_property(_scheduled GLOBAL PROPERTY LTO_COMPILE_COMMANDS_SCHEDULED)
+    if(NOT _scheduled)
+        set_property(GLOBAL PROPERTY LTO_COMPILE_COMMANDS_SCHEDULED TRUE)
+        cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL _lto_write_compile_commands)
+    endif()
+endfunction()
+
+# Write compile_commands_lto.json and merge it into compile_commands.json
+#
+# compile_commands.json is produced by the generator after configuration, so
+# the merge runs as part of the build (lto_compile_commands target) whenever
+# either database or the usage requirements of an LTO target change.
+function(_lto_write_compile_commands)
+    get_property(_entries GLOBAL PROPERTY LTO_COMPILE_COMMANDS)
+    string(JOIN ",\n" _content ${_entries})
+    set(_content "[\n${_content}\n]\n")
+
+    set(_lto_db "${CMAKE_BINARY_DIR}/compile_commands_lto.json")
+    set(_db "${CMAKE_BINARY_DIR}/compile_commands.json")
+    set(_stamp "${CMAKE_BINARY_DIR}/CMakeFiles/compile_commands_lto.stamp")
+    get_property(_flags_files GLOBAL PROPERTY LTO_COMPILE_FLAGS_FILES)
+    list(REMOVE_DUPLICATES _flags_files)
+
+    # Only write the file if content has changed to avoid needless merges
+    set(_write_file TRUE)
+    if(EXISTS "${_lto_db}")
+        file(READ "${_lto_db}" _existing_content)
+        if("${_existing_content}" STREQUAL "${_content}")
+            set(_write_file FALSE)
+        endif()
+    endif()
+    if(_write_file)
+        file(WRITE "${_lto_db}" "${_content}")
+    endif()
+
+    # The generator only writes compile_commands.json if some target is
+    # compiled natively, which is not the case when every target goes through
+    # LTO (ENABLE_LTO_BITCODE). Start from an empty database then.
+    if(NOT EXISTS "${_db}")
+        file(WRITE "${_db}" "[\n]\n")
+    endif()
+
+    add_custom_command(
+        OUTPUT "${_stamp}"
+        COMMAND ${CMAKE_COMMAND}
+            "-DCOMPILE_COMMANDS=${_db}"
+            "-DLTO_COMPILE_COMMANDS=${_lto_db}"
+            -P "${MSVC_LTO_MODULE_DIR}/MSVC_MergeCompileCommands.cmake"
+        COMMAND ${CMAKE_COMMAND} -E touch "${_stamp}"
+        DEPENDS "${_db}" "${_lto_db}" ${_flags_files}
+        COMMENT "Adding LTO bitcode compiles to compile_commands.json"
+        VERBATIM
+    )
+    add_custom_target(lto_compile_commands ALL DEPENDS "${_stamp}")
+endfunction()
+
 # Core function to compile sources to bitcode (C/C++) or object (ASM)
 # 
 # Parameters:
@@ -45,6 +145,25 @@ function(_compile_sources_to_bitcode target_name source_files compile_flags bc_o
     set(_bc_dir "${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/${target_name}.dir")
     file(MAKE_DIRECTORY "${_bc_dir}")
     
+    # Usage requirements of the target (target_compile_definitions,
+    # target_include_directories, target_compile_options, target_win_common).
+    # The target itself is created after the bitcode commands, so they are
+    # read through generator expressions at generate time, like for native
+    # targets. For compile_commands.json the same values are written to
+    # <target>.lto_flags.rsp, one argument per line.
+    set(_defs "$<TARGET_PROPERTY:${target_name},COMPILE_DEFINITIONS>")
+    set(_include_dirs "$<TARGET_PROPERTY:${target_name},INCLUDE_DIRECTORIES>")
+    set(_target_flags
+        "$<$<NOT:$<STREQUAL:${_defs},>>:/D$<JOIN:${_defs},$<SEMICOLON>/D>>"
+        "$<$<NOT:$<STREQUAL:${_include_dirs},>>:/I$<JOIN:${_include_dirs},$<SEMICOLON>/I>>"
+        "$<TARGET_PROPERTY:${target_name},COMPILE_OPTIONS>"
+    )
+    set(_flags_file "${_bc_dir}/${target_name}.lto_flags.rsp")
+    if(CMAKE_EXPORT_COMPILE_COMMANDS)
+        file(GENERATE OUTPUT "${_flags_file}" CONTENT "$<JOIN:${_target_flags},\n>\n")
+        set_property(GLOBAL APPEND PROPERTY LTO_COMPILE_FLAGS_FILES "${_flags_file}")
+    endif()
+    
     foreach(_source ${source_files})
         _get_source_type("${_source}" _source_type)
         
@@ -63,6 +182,22 @@ function(_compile_sources_to_bitcode target_name source_files compile_flags bc_o
                 set(_lang_flag "/TP")
             endif()
             
+            # Per-source options (e.g. /arch:AVX2 for a single kernel file)
+            get_source_file_property(_source_options "${_source}" COMPILE_OPTIONS)
+            if(NOT _source_options)
+                set(_source_options "")
+            endif()
+            
+            # Header dependencies: clang writes a make-style depfile that
+            # the generator reads back (Makefile and Ninja generators only)
+            set(_depfile_flags "")
+            set(_depfile_args "")
+            if(CMAKE_GENERATOR MATCHES "Ninja|Makefiles")
+                set(_dep_file "${_bc_file}.d")
+                set(_depfile_flags "/clang:-MD" "/clang:-MF${_dep_file}")
+                set(_depfile_args DEPFILE "${_dep_file}")
+            endif()
+            
             # Compile to bitcode using clang-cl
             # -Xclang -emit-llvm tells clang to output LLVM IR
             add_custom_command(
@@ -72,13 +207,32 @@ function(_compile_sources_to_bitcode target_name source_files compile_flags bc_o
                     /c
                     -Xclang -emit-llvm
                     ${compile_flags}
+                    ${_target_flags}
+                    ${_source_options}
+                    ${_depfile_flags}
                     "/Fo${_bc_file}"
                     "${_source_abs}"
                 DEPENDS "${_source_abs}"
+                ${_depfile_args}
                 COMMENT "Compiling ${_source_name} to LLVM bitcode"
+                COMMAND_EXPAND_LISTS
                 VERBATIM
             )
             
+            # Export the same command line for clangd / clang-tidy (without
+            # the depfile flags, which only matter to the build)
+            _lto_record_compile_command("${_source_abs}" "${_bc_file}"
+                ${CMAKE_C_COMPILER}
+                ${_lang_flag}
+                /c
+                -Xclang -emit-llvm
+                ${compile_flags}
+                "@${_flags_file}"
+                ${_source_options}
+                "/Fo${_bc_file}"
+                "${_source_abs}"
+            )
+            
             list(APPEND _bc_files "${_bc_file}")
             
         elseif(_source_type STREQUAL "ASM")
@@ -106,13 +260,22 @@ endfunction()
 
 # Function to merge, optimize, and compile bitcode files
 # Returns the final object file path
+#
+# Optional arguments:
+#   PGO_FLAGS: Extra flags for opt (see _pgo_lto_flags)
+#   PGO_DEPENDS: Files the opt step depends on (e.g. the profile)
+#   LLC_FLAGS: Extra flags for llc (e.g. -function-sections)
+#
 function(_lto_merge_and_optimize target_name bc_files opt_passes output_obj_var)
+    cmake_parse_arguments(ARG "" "" "PGO_FLAGS;PGO_DEPENDS;LLC_FLAGS" ${ARGN})
+
     if(NOT bc_files)
         set(${output_obj_var} "" PARENT_SCOPE)
         return()
     endif()
 
     set(_bc_dir "${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/${target_name}.dir")
+    file(MAKE_DIRECTORY "${_bc_dir}")
     set(_merged_bc "${_bc_dir}/${target_name}_merged.bc")
     set(_optimized_bc "${_bc_dir}/${target_name}_optimized.bc")
     set(_final_obj "${_bc_dir}/${target_name}_lto.obj")
@@ -160,10 +323,16 @@ function(_lto_merge_and_optimize target_name bc_files opt_passes output_obj_var)
         list(APPEND _opt_deps ${_plugin_deps})
     endif()
     
+    # Add profile dependencies to opt command
+    if(ARG_PGO_DEPENDS)
+        list(APPEND _opt_deps ${ARG_PGO_DEPENDS})
+    endif()
+    
     add_custom_command(
         OUTPUT "${_optimized_bc}"
         COMMAND ${LLVM_OPT_PATH}
             ${_lto_opt_passes_list}
+            ${ARG_PGO_FLAGS}
             -o "${_optimized_bc}"
             "${_merged_bc}"
         DEPENDS ${_opt_deps}
@@ -177,6 +346,7 @@ function(_lto_merge_and_optimize target_name bc_files opt_passes output_obj_var)
         COMMAND ${LLVM_LLC_PATH}
             -filetype=obj
             -mtriple=x86_64-pc-windows-msvc
+            ${ARG_LLC_FLAGS}
             -o "${_final_obj}"
             "${_optimized_bc}"
         DEPENDS "${_optimized_bc}"
@@ -0,0 +1,136 @@
+# =============================================================================
+# Merge LTO Bitcode Compiles into compile_commands.json (script mode)
+# =============================================================================
+# Usage:
+#   cmake -DCOMPILE_COMMANDS=<compile_commands.json>
+#         -DLTO_COMPILE_COMMANDS=<compile_commands_lto.json>
+#         -P MSVC_MergeCompileCommands.cmake
+#
+# Entries of COMPILE_COMMANDS with the same file / output pair as an LTO entry
+# are dropped and the LTO entries are appended. The generator does not rewrite
+# the database when no target compiles natively, so this replaces the entries
+# of an earlier merge instead of piling up stale command lines in front of
+# the current ones (clangd uses the first match). Running the script again is
+# a no-op.
+#
+# An @<target>.lto_flags.rsp argument of an LTO entry is replaced by the
+# arguments listed in that file (usage requirements of the target, written
+# at generate time).
+# =============================================================================
+
+cmake_minimum_required(VERSION 3.20) # string(JSON)
+
+if(NOT EXISTS "${LTO_COMPILE_COMMANDS}")
+    return()
+endif()
+
+file(READ "${LTO_COMPILE_COMMANDS}" _lto_db)
+if(EXISTS "${COMPILE_COMMANDS}")
+    file(READ "${COMPILE_COMMANDS}" _db)
+else()
+    set(_db "[]")
+endif()
+
+string(JSON _lto_count ERROR_VARIABLE _error LENGTH "${_lto_db}")
+if(NOT _error)
+    string(JSON _count ERROR_VARIABLE _error LENGTH "${_db}")
+endif()
+if(_error)
+    message(WARNING "[MSVC-Toolchain] Cannot merge LTO compile commands: ${_error}")
+    return()
+endif()
+
+# Key of an entry: its file / output pair
+function(_merge_entry_key json index output_var)
+    string(JSON _file ERROR_VARIABLE _error GET "${json}" ${index} file)
+    string(JSON _output ERROR_VARIABLE _error GET "${json}" ${index} output)
+    set(${output_var} "${_file}|${_output}" PARENT_SCOPE)
+endfunction()
+
+# JSON string literal of a value
+function(_merge_json_escape input output_var)
+    string(REPLACE "\\" "\\\\" _escaped "${input}")
+    string(REPLACE "\"" "\\\"" _escaped "${_escaped}")
+    set(${output_var} "\"${_escaped}\"" PARENT_SCOPE)
+endfunction()
+
+# Expand the @<target>.lto_flags.rsp argument of an LTO entry
+function(_merge_expand_lto_entry entry output_var)
+    string(JSON _arg_count ERROR_VARIABLE _error LENGTH "${entry}" arguments)
+    if(_error OR _arg_count EQUAL 0)
+        set(${output_var} "${entry}" PARENT_SCOPE)
+        return()
+    endif()
+
+    set(_args "")
+    set(_separator "")
+    math(EXPR _last "${_arg_count} - 1")
+    foreach(_index RANGE ${_last})
+        string(JSON _arg GET "${entry}" arguments ${_index})
+        set(_flags_file "")
+        if(_arg MATCHES "^@(.+\\.lto_flags\\.rsp)$")
+            set(_flags_file "${CMAKE_MATCH_1}")
+        endif()
+        if(_flags_file AND EXISTS "${_flags_file}")
+            file(STRINGS "${_flags_file}" _flags)
+            foreach(_flag IN LISTS _flags)
+                if(NOT _flag STREQUAL "")
+                    _merge_json_escape("${_flag}" _escaped)
+                    string(APPEND _args "${_separator}${_escaped}")
+                    set(_separator ", ")
+                endif()
+            endforeach()
+        else()
+            _merge_json_escape("${_arg}" _escaped)
+            string(APPEND _args "${_separator}${_escaped}")
+            set(_separator ", ")
+        endif()
+    endforeach()
+
+    string(JSON _entry SET "${entry}" arguments "[${_args}]")
+    set(${output_var} "${_entry}" PARENT_SCOPE)
+endfunction()
+
+# Entries are concatenated as strings: a command line may contain ';'
+set(_content "")
+set(_separator "")
+
+set(_lto_keys "")
+if(_lto_count GREATER 0)
+    math(EXPR _last "${_lto_count} - 1")
+    foreach(_index RANGE ${_last})
+        _merge_entry_key("${_lto_db}" ${_index} _key)
+        list(APPEND _lto_keys "${_key}")
+    endforeach()
+endif()
+
+# Native entries, without the ones the LTO database replaces
+if(_count GREATER 0)
+    math(EXPR _last "${_count} - 1")
+    foreach(_index RANGE ${_last})
+        _merge_entry_key("${_db}" ${_index} _key)
+        list(FIND _lto_keys "${_key}" _found)
+        if(_found EQUAL -1)
+            string(JSON _entry GET "${_db}" ${_index})
+            string(APPEND _content "${_separator}${_entry}")
+            set(_separator ",\n")
+        endif()
+    endforeach()
+endif()
+
+if(_lto_count GREATER 0)
+    math(EXPR _last "${_lto_count} - 1")
+    foreach(_index RANGE ${_last})
+        string(JSON _entry GET "${_lto_db}" ${_index})
+        _merge_expand_lto_entry("${_entry}" _entry)
+        string(APPEND _content "${_separator}${_entry}")
+        set(_separator ",\n")
+    endforeach()
+endif()
+
+set(_content "[\n${_content}\n]\n")
+
+# Only write the file if content has changed
+if(NOT _db STREQUAL _content)
+    file(WRITE "${COMPILE_COMMANDS}" "${_content}")
+endif()
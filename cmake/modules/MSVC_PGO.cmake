@@ -0,0 +1,289 @@
+# =============================================================================
+# Profile-Guided Optimization Support
+# =============================================================================
+# Target functions accept the following PGO arguments:
+#
+#   PGO_INSTRUMENT        Additionally build an instrumented variant of the
+#                         target named <target>_pgo_instr
+#   PROFILE <files...>    Local profile files used to optimize the target
+#                         (.profraw / .profdata, or sample profiles)
+#   PROFILE_KIND <kind>   INSTR (default) or SAMPLE
+#
+# Kernel drivers only accept PROFILE, as the profile runtime is user mode only.
+#
+# Raw profiles and multiple profile files are merged with llvm-profdata as a
+# build step, so profiles collected on other machines can simply be copied
+# next to the sources. Nothing is fetched from outside the local file system.
+# =============================================================================
+
+# Validate the PGO arguments of a target
+function(_pgo_check_arguments target_name instrument profile_files profile_kind)
+    if(profile_kind AND NOT profile_kind MATCHES "^(INSTR|SAMPLE)$")
+        toolchain_log("ERROR" "Unknown PROFILE_KIND '${profile_kind}' for target ${target_name} (expected INSTR or SAMPLE)")
+    endif()
+
+    if(instrument AND profile_kind STREQUAL "SAMPLE")
+        toolchain_log("ERROR" "PGO_INSTRUMENT cannot be combined with PROFILE_KIND SAMPLE for target ${target_name}; sample profiles are collected from the regular binary")
+    endif()
+
+    foreach(_profile ${profile_files})
+        get_filename_component(_profile_abs "${_profile}" ABSOLUTE)
+        if(NOT EXISTS "${_profile_abs}")
+            toolchain_log("ERROR" "Profile file for target ${target_name} not found: ${_profile_abs}")
+        endif()
+    endforeach()
+endfunction()
+
+# Validate the PGO arguments of a kernel driver
+function(_pgo_check_driver_arguments target_name instrument profile_files profile_kind)
+    if(instrument)
+        toolchain_log("ERROR" "PGO_INSTRUMENT is not supported for kernel driver ${target_name}; the profile runtime is user mode only")
+    endif()
+    _pgo_check_arguments(${target_name} "${instrument}" "${profile_files}" "${profile_kind}")
+endfunction()
+
+# Validate the opt pipeline of an LTO target that uses PGO arguments
+#
+# opt only applies -pgo-kind / -profile-file inside the default pipelines
+# (-O<n>, or default<O<n>> / lto<O<n>> in -passes=). A custom -passes= list
+# without one of them would silently build an uninstrumented variant or
+# ignore the profile.
+#
+# Parameters:
+#   target_name: Name of the target
+#   instrument: Whether PGO_INSTRUMENT was given
+#   profile_files: List of profile files (may be empty)
+#   opt_passes: OPT_PASSES of the target (empty for LTO_OPT_PASSES)
+#
+function(_pgo_check_lto_passes target_name instrument profile_files opt_passes)
+    if(NOT instrument AND NOT profile_files)
+        return()
+    endif()
+
+    if(opt_passes)
+        set(_passes "${opt_passes}")
+    else()
+        set(_passes "${LTO_OPT_PASSES}")
+    endif()
+
+    if(_passes MATCHES "(^|[ \t])-O[0-3sz]([ \t]|$)" OR _passes MATCHES "(default|lto|lto-pre-link|thinlto|thinlto-pre-link)<O[0-3sz]>")
+        return()
+    endif()
+
+    toolchain_log("ERROR" "PGO arguments of LTO target ${target_name} require a default opt pipeline, but its passes are '${_passes}'. Add -O<n> or default<O<n>> (e.g. -passes=default<O2>,mypass), otherwise the profile is ignored and the instrumented variant contains no instrumentation.")
+endfunction()
+
+# Resolve the PROFILE files of a target into a single profile file
+#
+# A single .profdata (INSTR) or a single sample profile (SAMPLE) is used as is.
+# Anything else (.profraw files, several profiles) is merged with llvm-profdata
+# into the target's build directory.
+#
+# Parameters:
+#   target_name: Name of the target (used for directory naming)
+#   profile_files: List of profile files
+#   profile_kind: INSTR or SAMPLE
+#   output_var: [Output] Path of the resolved profile file
+#
+function(_pgo_resolve_profile target_name profile_files profile_kind output_var)
+    if(NOT profile_files)
+        set(${output_var} "" PARENT_SCOPE)
+        return()
+    endif()
+
+    set(_profiles_abs "")
+    foreach(_profile ${profile_files})
+        get_filename_component(_profile_abs "${_profile}" ABSOLUTE)
+        list(APPEND _profiles_abs "${_profile_abs}")
+    endforeach()
+
+    list(LENGTH _profiles_abs _profile_count)
+    list(GET _profiles_abs 0 _first_profile)
+    get_filename_component(_first_ext "${_first_profile}" EXT)
+    string(TOLOWER "${_first_ext}" _first_ext)
+
+    if(_profile_count EQUAL 1 AND (profile_kind STREQUAL "SAMPLE" OR _first_ext STREQUAL ".profdata"))
+        set(${output_var} "${_first_profile}" PARENT_SCOPE)
+        return()
+    endif()
+
+    if(NOT LLVM_PROFDATA_PATH)
+        toolchain_log("ERROR" "Merging profiles for target ${target_name} requires llvm-profdata. Please install LLVM tools or pass a single indexed .profdata file.")
+    endif()
+
+    set(_bc_dir "${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/${target_name}.dir")
+    file(MAKE_DIRECTORY "${_bc_dir}")
+
+    if(profile_kind STREQUAL "SAMPLE")
+        set(_merged_profile "${_bc_dir}/${target_name}.sampleprof")
+        set(_merge_mode "-sample")
+    else()
+        set(_merged_profile "${_bc_dir}/${target_name}.profdata")
+        set(_merge_mode "-instr")
+    endif()
+
+    add_custom_command(
+        OUTPUT "${_merged_profile}"
+        COMMAND ${LLVM_PROFDATA_PATH}
+            merge
+            ${_merge_mode}
+            -o "${_merged_profile}"
+            ${_profiles_abs}
+        DEPENDS ${_profiles_abs}
+        COMMENT "Merging profiles for ${target_name}"
+        VERBATIM
+    )
+
+    set(${output_var} "${_merged_profile}" PARENT_SCOPE)
+endfunction()
+
+# clang-cl flags for a standard (non-LTO) target
+#
+# Parameters:
+#   instrument: Whether the flags are for the instrumented variant
+#   profile: Resolved profile file (may be empty)
+#   profile_kind: INSTR or SAMPLE
+#   output_var: [Output] List of compile flags
+#
+function(_pgo_compile_flags instrument profile profile_kind output_var)
+    set(_flags "")
+    if(instrument)
+        list(APPEND _flags "-fprofile-generate")
+    elseif(profile)
+        if(profile_kind STREQUAL "SAMPLE")
+            # Sample profiles are matched through line tables
+            list(APPEND _flags "-gline-tables-only" "/clang:-fprofile-sample-use=${profile}")
+        else()
+            list(APPEND _flags "-fprofile-use=${profile}")
+        endif()
+    endif()
+    set(${output_var} "${_flags}" PARENT_SCOPE)
+endfunction()
+
+# Flags for the bitcode compile and the opt stage of an LTO target
+#
+# The profile is applied by opt on the merged module (IR-level PGO), so the
+# instrumented variant and the optimized target can share the same bitcode.
+# opt only honours -pgo-kind for the default pipelines (see _pgo_check_lto_passes).
+#
+# Parameters:
+#   instrument: Whether the flags are for the instrumented variant
+#   profile: Resolved profile file (may be empty)
+#   profile_kind: INSTR or SAMPLE
+#   compile_flags_var: [Output] Extra flags for the bitcode compile
+#   opt_flags_var: [Output] Extra flags for opt
+#
+function(_pgo_lto_flags instrument profile profile_kind compile_flags_var opt_flags_var)
+    set(_compile_flags "")
+    set(_opt_flags "")
+    if(instrument)
+        list(APPEND _opt_flags "-pgo-kind=pgo-instr-gen-pipeline")
+    elseif(profile)
+        if(profile_kind STREQUAL "SAMPLE")
+            list(APPEND _compile_flags "-gline-tables-only")
+            list(APPEND _opt_flags "-pgo-kind=pgo-sample-use-pipeline" "-profile-file=${profile}")
+        else()
+            list(APPEND _opt_flags "-pgo-kind=pgo-instr-use-pipeline" "-profile-file=${profile}")
+        endif()
+    endif()
+    set(${compile_flags_var} "${_compile_flags}" PARENT_SCOPE)
+    set(${opt_flags_var} "${_opt_flags}" PARENT_SCOPE)
+endfunction()
+
+# Profile runtime library linked into instrumented binaries
+function(_pgo_runtime_libs output_var)
+    if(NOT PGO_PROFILE_RUNTIME)
+        toolchain_log("ERROR" "PGO_INSTRUMENT requires the clang profile runtime (clang_rt.profile-x86_64.lib). Set PGO_PROFILE_RUNTIME to a local copy of it.")
+    endif()
+    set(${output_var} "${PGO_PROFILE_RUNTIME}" PARENT_SCOPE)
+endfunction()
+
+# Make a standard target rebuild when its profile changes
+#
+# OBJECT_DEPENDS is a source file property, so other targets of the directory
+# that compile the same sources (e.g. the instrumented variant) are rebuilt too.
+function(_pgo_add_profile_dependency target_name sources profile)
+    if(NOT profile)
+        return()
+    endif()
+
+    foreach(_source ${sources})
+        _get_source_type("${_source}" _source_type)
+        if(_source_type STREQUAL "C_CXX")
+            set_property(SOURCE "${_source}" APPEND PROPERTY OBJECT_DEPENDS "${profile}")
+        endif()
+    endforeach()
+
+    # Merge generated profiles once, before anything compiles those sources
+    get_source_file_property(_generated "${profile}" GENERATED)
+    if(_generated)
+        add_custom_target(${target_name}_profdata DEPENDS "${profile}")
+        add_dependencies(${target_name} ${target_name}_profdata)
+        if(TARGET ${target_name}_pgo_instr)
+            add_dependencies(${target_name}_pgo_instr ${target_name}_profdata)
+        endif()
+    endif()
+endfunction()
+
+# Create the instrumented variant <target>_pgo_instr of a standard target
+#
+# The variant copies the settings the add_win_* function gave the target, so it
+# must be called before any profile-use flags are added to it. target_win_common
+# applies its settings to the variant too; other settings added later (e.g.
+# target_compile_definitions) have to be applied to the variant explicitly.
+#
+# Parameters:
+#   target_name: Name of the (already created) target
+#   sources: List of source files
+#
+function(_pgo_add_instrumented_variant target_name sources)
+    set(_variant "${target_name}_pgo_instr")
+    get_target_property(_type ${target_name} TYPE)
+
+    if(_type STREQUAL "EXECUTABLE")
+        add_executable(${_variant} ${sources})
+    elseif(_type STREQUAL "SHARED_LIBRARY")
+        add_library(${_variant} SHARED ${sources})
+    elseif(_type STREQUAL "STATIC_LIBRARY")
+        add_library(${_variant} STATIC ${sources})
+    else()
+        toolchain_log("ERROR" "PGO_INSTRUMENT is not supported for target ${target_name} of type ${_type}")
+    endif()
+
+    foreach(_prop SUFFIX COMPILE_OPTIONS COMPILE_DEFINITIONS INCLUDE_DIRECTORIES LINK_OPTIONS LINK_LIBRARIES)
+        get_target_property(_value ${target_name} ${_prop})
+        if(_value)
+            set_property(TARGET ${_variant} PROPERTY ${_prop} "${_value}")
+        endif()
+    endforeach()
+
+    _pgo_compile_flags(TRUE "" "" _gen_flags)
+    target_compile_options(${_variant} PRIVATE ${_gen_flags})
+
+    if(NOT _type STREQUAL "STATIC_LIBRARY")
+        _pgo_runtime_libs(_runtime_libs)
+        target_link_libraries(${_variant} PRIVATE ${_runtime_libs})
+    endif()
+endfunction()
+
+# Apply the PGO arguments to a standard (non-LTO) target
+#
+# Parameters:
+#   target_name: Name of the (already created) target
+#   sources: List of source files
+#   instrument: Whether to create the <target>_pgo_instr variant
+#   profile_files: List of profile files (may be empty)
+#   profile_kind: INSTR or SAMPLE
+#
+function(_pgo_setup_target target_name sources instrument profile_files profile_kind)
+    if(instrument)
+        _pgo_add_instrumented_variant(${target_name} "${sources}")
+    endif()
+
+    _pgo_resolve_profile(${target_name} "${profile_files}" "${profile_kind}" _profile)
+    _pgo_compile_flags(FALSE "${_profile}" "${profile_kind}" _pgo_flags)
+    if(_pgo_flags)
+        target_compile_options(${target_name} PRIVATE ${_pgo_flags})
+        _pgo_add_profile_dependency(${target_name} "${sources}" "${_profile}")
+    endif()
+endfunction()
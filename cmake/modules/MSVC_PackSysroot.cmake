@@ -0,0 +1,185 @@
+# =============================================================================
+# Pack MSVC / WDK Trees into a Case-Normalized Sysroot (script mode)
+# =============================================================================
+# Usage (normally through the msvc_sysroot target):
+#   cmake -DSYSROOT=<output dir>
+#         -DUSER_INCLUDE_DIRS=<dir|dir|...> -DKERNEL_INCLUDE_DIRS=<dir|dir|...>
+#         -DUSER_LIB_DIRS=<dir|dir|...> -DKERNEL_LIB_DIRS=<dir|dir|...>
+#         [-DLINK_MODE=HARD|SYMBOLIC|COPY] [-DWDKVERSION=<version>]
+#         -P MSVC_PackSysroot.cmake
+#
+# Layout of the generated sysroot:
+#   include/user    User mode headers (MSVC, ucrt, shared, um)
+#   include/kernel  Kernel mode headers (km, kmdf, shared, ucrt, MSVC)
+#   lib/user        User mode libraries
+#   lib/kernel      Kernel mode libraries
+#   sysroot.cmake   Manifest checked when the sysroot is used
+#
+# Directories are merged in the given order (first one wins, like the -imsvc
+# search order), and every path is stored in lowercase. Files additionally keep
+# their original spelling, and headers get an extra link for every differently
+# cased spelling used by an #include inside the SDK, so no VFS overlay is needed
+# on case-sensitive file systems.
+#
+# HARD (default) and COPY produce a self-contained image that can be moved or
+# cached; SYMBOLIC is the cheapest but points back into the SDK installation.
+# =============================================================================
+
+if(NOT SYSROOT)
+    message(FATAL_ERROR "[MSVC-Sysroot] SYSROOT must be defined")
+endif()
+
+if(NOT LINK_MODE)
+    set(LINK_MODE "HARD")
+endif()
+if(NOT LINK_MODE MATCHES "^(HARD|SYMBOLIC|COPY)$")
+    message(FATAL_ERROR "[MSVC-Sysroot] Unknown LINK_MODE '${LINK_MODE}' (expected HARD, SYMBOLIC or COPY)")
+endif()
+
+# Directory lists are passed with '|' separators
+foreach(_var USER_INCLUDE_DIRS KERNEL_INCLUDE_DIRS USER_LIB_DIRS KERNEL_LIB_DIRS)
+    string(REPLACE "|" ";" ${_var} "${${_var}}")
+endforeach()
+
+# Link (or copy) a single file into the sysroot
+function(_sysroot_link_file source_file dest_file)
+    get_filename_component(_dest_dir "${dest_file}" DIRECTORY)
+    file(MAKE_DIRECTORY "${_dest_dir}")
+
+    if(LINK_MODE STREQUAL "COPY")
+        configure_file("${source_file}" "${dest_file}" COPYONLY)
+    elseif(LINK_MODE STREQUAL "SYMBOLIC")
+        file(CREATE_LINK "${source_file}" "${dest_file}" SYMBOLIC COPY_ON_ERROR)
+    else()
+        file(CREATE_LINK "${source_file}" "${dest_file}" COPY_ON_ERROR)
+    endif()
+endfunction()
+
+# Merge a list of directories into one lowercase tree
+#
+# Parameters:
+#   root: Destination directory
+#   source_dirs: Directories to merge, in priority order
+#   file_count_var: [Output] Number of files placed into the tree
+#
+function(_sysroot_merge_dirs root source_dirs file_count_var)
+    set(_count 0)
+
+    foreach(_dir ${source_dirs})
+        if(NOT IS_DIRECTORY "${_dir}")
+            message(WARNING "[MSVC-Sysroot] Skipping missing directory: ${_dir}")
+            continue()
+        endif()
+
+        file(GLOB_RECURSE _files RELATIVE "${_dir}" "${_dir}/*")
+        foreach(_rel ${_files})
+            string(TOLOWER "${_rel}" _lower)
+            if(EXISTS "${root}/${_lower}")
+                # Shadowed by a directory earlier in the search order
+                continue()
+            endif()
+
+            _sysroot_link_file("${_dir}/${_rel}" "${root}/${_lower}")
+            math(EXPR _count "${_count} + 1")
+
+            # Keep the original spelling of the file name
+            get_filename_component(_name "${_rel}" NAME)
+            string(TOLOWER "${_name}" _lower_name)
+            if(NOT _name STREQUAL _lower_name)
+                get_filename_component(_lower_dir "${_lower}" DIRECTORY)
+                if(_lower_dir)
+                    set(_spelled "${root}/${_lower_dir}/${_name}")
+                else()
+                    set(_spelled "${root}/${_name}")
+                endif()
+                if(NOT EXISTS "${_spelled}")
+                    _sysroot_link_file("${_dir}/${_rel}" "${_spelled}")
+                endif()
+            endif()
+        endforeach()
+    endforeach()
+
+    set(${file_count_var} ${_count} PARENT_SCOPE)
+endfunction()
+
+# Add links for differently cased #include spellings found in the headers
+#
+# Parameters:
+#   root: Merged include tree
+#   alias_count_var: [Output] Number of links created
+#
+function(_sysroot_add_include_spellings root alias_count_var)
+    set(_count 0)
+
+    file(GLOB_RECURSE _headers RELATIVE "${root}" "${root}/*")
+    foreach(_rel ${_headers})
+        # Only scan the lowercase entry of each file
+        string(TOLOWER "${_rel}" _lower_rel)
+        if(NOT _rel STREQUAL _lower_rel)
+            continue()
+        endif()
+
+        file(STRINGS "${root}/${_rel}" _lines REGEX "^[ \t]*#[ \t]*include[ \t]*[<\"]")
+        get_filename_component(_rel_dir "${_rel}" DIRECTORY)
+
+        foreach(_line ${_lines})
+            if(NOT _line MATCHES "#[ \t]*include[ \t]*[<\"]([^>\"]+)[>\"]")
+                continue()
+            endif()
+            set(_spelled "${CMAKE_MATCH_1}")
+            string(REPLACE "\\" "/" _spelled "${_spelled}")
+            string(TOLOWER "${_spelled}" _lower)
+            if(_spelled STREQUAL _lower OR _spelled MATCHES "\\.\\.")
+                continue()
+            endif()
+
+            # Resolve relative to the including header first, then the root
+            set(_base "")
+            if(_rel_dir AND EXISTS "${root}/${_rel_dir}/${_lower}")
+                set(_base "${root}/${_rel_dir}")
+            elseif(EXISTS "${root}/${_lower}")
+                set(_base "${root}")
+            endif()
+
+            if(_base AND NOT EXISTS "${_base}/${_spelled}" AND NOT IS_DIRECTORY "${_base}/${_lower}")
+                _sysroot_link_file("${_base}/${_lower}" "${_base}/${_spelled}")
+                math(EXPR _count "${_count} + 1")
+            endif()
+        endforeach()
+    endforeach()
+
+    set(${alias_count_var} ${_count} PARENT_SCOPE)
+endfunction()
+
+# -----------------------------------------------------------------------------
+# Pack
+# -----------------------------------------------------------------------------
+
+# Only remove the parts of SYSROOT this script owns
+file(REMOVE_RECURSE
+    "${SYSROOT}/include/user"
+    "${SYSROOT}/include/kernel"
+    "${SYSROOT}/lib/user"
+    "${SYSROOT}/lib/kernel"
+    "${SYSROOT}/sysroot.cmake"
+)
+
+foreach(_mode user kernel)
+    string(TOUPPER "${_mode}" _MODE)
+
+    _sysroot_merge_dirs("${SYSROOT}/include/${_mode}" "${${_MODE}_INCLUDE_DIRS}" _header_count)
+    _sysroot_add_include_spellings("${SYSROOT}/include/${_mode}" _alias_count)
+    message(STATUS "[MSVC-Sysroot] include/${_mode}: ${_header_count} files, ${_alias_count} spelling links")
+
+    _sysroot_merge_dirs("${SYSROOT}/lib/${_mode}" "${${_MODE}_LIB_DIRS}" _lib_count)
+    message(STATUS "[MSVC-Sysroot] lib/${_mode}: ${_lib_count} files")
+endforeach()
+
+# Manifest (written last, so an interrupted pack is never picked up)
+file(WRITE "${SYSROOT}/sysroot.cmake"
+    "# Generated by MSVC_PackSysroot.cmake\n"
+    "set(MSVC_SYSROOT_FORMAT 1)\n"
+    "set(MSVC_SYSROOT_WDKVERSION \"${WDKVERSION}\")\n"
+    "set(MSVC_SYSROOT_LINK_MODE \"${LINK_MODE}\")\n"
+)
+message(STATUS "[MSVC-Sysroot] Packed sysroot: ${SYSROOT} (${LINK_MODE})")
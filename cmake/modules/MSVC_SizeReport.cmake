@@ -0,0 +1,83 @@
+# =============================================================================
+# Per-Symbol Size Report from an lld-link Map File (script mode)
+# =============================================================================
+# Usage:
+#   cmake -DMAP_FILE=<file from /lldmap> -DREPORT_FILE=<output>
+#         [-DIMAGE_FILE=<linked image>] -P MSVC_SizeReport.cmake
+#
+# With per-function / per-data sections every input chunk of the map holds a
+# single symbol, so the chunk size is reported as the size of that symbol.
+# Lines of the report are sorted by size, largest first, to keep diffs between
+# builds short.
+# =============================================================================
+
+if(NOT EXISTS "${MAP_FILE}")
+    message(FATAL_ERROR "[MSVC-SizeReport] Map file not found: ${MAP_FILE}")
+endif()
+
+file(STRINGS "${MAP_FILE}" _lines)
+
+set(_sections "")
+set(_entries "")
+set(_section "")
+set(_chunk_size "")
+set(_chunk_input "")
+
+# Record the pending chunk (if any) under the given symbol name
+macro(_size_report_flush_chunk symbol)
+    if(NOT _chunk_size STREQUAL "")
+        # Zero-padded so a natural sort orders by size
+        string(LENGTH "${_chunk_size}" _len)
+        math(EXPR _pad "10 - ${_len}")
+        string(REPEAT "0" ${_pad} _zeros)
+        list(APPEND _entries "${_zeros}${_chunk_size} ${_section} ${symbol} (${_chunk_input})")
+        set(_chunk_size "")
+    endif()
+endmacro()
+
+foreach(_line ${_lines})
+    # Address Size Align, followed by the indented Out / In / Symbol column
+    if(NOT _line MATCHES "^([0-9a-fA-F]+) +([0-9a-fA-F]+) +([0-9]+) (.*)$")
+        continue()
+    endif()
+    math(EXPR _size "0x${CMAKE_MATCH_2}")
+    set(_rest "${CMAKE_MATCH_4}")
+
+    if(_rest MATCHES "^                (.+)$")
+        # Symbol: attribute the enclosing chunk to its first symbol
+        _size_report_flush_chunk("${CMAKE_MATCH_1}")
+    elseif(_rest MATCHES "^        (.+)$")
+        # Input chunk
+        _size_report_flush_chunk("<anonymous>")
+        set(_chunk_size "${_size}")
+        set(_chunk_input "${CMAKE_MATCH_1}")
+    else()
+        # Output section
+        _size_report_flush_chunk("<anonymous>")
+        string(STRIP "${_rest}" _section)
+        list(APPEND _sections "${_section} ${_size}")
+    endif()
+endforeach()
+_size_report_flush_chunk("<anonymous>")
+
+list(SORT _entries COMPARE NATURAL ORDER DESCENDING)
+
+# Write report
+set(_report "# Size report generated from ${MAP_FILE}\n")
+if(IMAGE_FILE AND EXISTS "${IMAGE_FILE}")
+    file(SIZE "${IMAGE_FILE}" _image_size)
+    string(APPEND _report "# Image: ${IMAGE_FILE} (${_image_size} bytes)\n")
+endif()
+
+string(APPEND _report "\n# Sections (name size)\n")
+foreach(_entry ${_sections})
+    string(APPEND _report "${_entry}\n")
+endforeach()
+
+string(APPEND _report "\n# Symbols (size section symbol (input))\n")
+foreach(_entry ${_entries})
+    string(REGEX REPLACE "^0+([0-9])" "\\1" _entry "${_entry}")
+    string(APPEND _report "${_entry}\n")
+endforeach()
+
+file(WRITE "${REPORT_FILE}" "${_report}")
@@ -0,0 +1,56 @@
+# =============================================================================
+# Packed Sysroot (Optional)
+# =============================================================================
+# The msvc_sysroot target packs the MSVC and WDK include/lib trees into one
+# case-normalized directory (see MSVC_PackSysroot.cmake). Pointing MSVC_SYSROOT
+# at the result replaces the per-directory -imsvc / /LIBPATH lists with a
+# single root per mode and drops the VFS overlay from every compile.
+#
+#   cmake --build build --target msvc_sysroot
+#   cmake -B build -DMSVC_SYSROOT=build/sysroot
+# =============================================================================
+
+set(MSVC_SYSROOT "" CACHE PATH "Packed sysroot used instead of the SDK trees and the VFS overlay")
+set(MSVC_SYSROOT_OUTPUT "${CMAKE_BINARY_DIR}/sysroot" CACHE PATH "Output directory of the msvc_sysroot target")
+set(MSVC_SYSROOT_LINK_MODE "HARD" CACHE STRING "How msvc_sysroot populates the sysroot (HARD, SYMBOLIC or COPY)")
+set_property(CACHE MSVC_SYSROOT_LINK_MODE PROPERTY STRINGS HARD SYMBOLIC COPY)
+
+# Tool target to pack the SDK trees (uses the search order from MSVC_Config)
+if(NOT TARGET msvc_sysroot AND NOT CMAKE_IN_TRY_COMPILE)
+    string(JOIN "|" _sysroot_user_includes ${MSVC_USER_MODE_INCLUDE_DIRS})
+    string(JOIN "|" _sysroot_kernel_includes ${MSVC_KERNEL_MODE_INCLUDE_DIRS})
+    string(JOIN "|" _sysroot_user_libs ${MSVC_USER_MODE_LIB_DIRS})
+    string(JOIN "|" _sysroot_kernel_libs ${MSVC_KERNEL_MODE_LIB_DIRS})
+
+    add_custom_target(msvc_sysroot
+        COMMAND ${CMAKE_COMMAND}
+            "-DSYSROOT=${MSVC_SYSROOT_OUTPUT}"
+            "-DUSER_INCLUDE_DIRS=${_sysroot_user_includes}"
+            "-DKERNEL_INCLUDE_DIRS=${_sysroot_kernel_includes}"
+            "-DUSER_LIB_DIRS=${_sysroot_user_libs}"
+            "-DKERNEL_LIB_DIRS=${_sysroot_kernel_libs}"
+            "-DLINK_MODE=${MSVC_SYSROOT_LINK_MODE}"
+            "-DWDKVERSION=${WDKVERSION}"
+            -P "${CMAKE_CURRENT_LIST_DIR}/MSVC_PackSysroot.cmake"
+        COMMENT "Packing MSVC/WDK sysroot into ${MSVC_SYSROOT_OUTPUT}"
+        VERBATIM
+    )
+endif()
+
+if(MSVC_SYSROOT)
+    if(NOT EXISTS "${MSVC_SYSROOT}/sysroot.cmake")
+        toolchain_log("ERROR" "MSVC_SYSROOT does not contain a packed sysroot: ${MSVC_SYSROOT} (build the msvc_sysroot target first)")
+    endif()
+
+    include("${MSVC_SYSROOT}/sysroot.cmake")
+    if(NOT "${MSVC_SYSROOT_WDKVERSION}" STREQUAL "${WDKVERSION}")
+        toolchain_log("WARNING" "Packed sysroot was created for WDK ${MSVC_SYSROOT_WDKVERSION}, but WDKVERSION is ${WDKVERSION}")
+    endif()
+
+    set(MSVC_USER_MODE_INCLUDE_DIRS "${MSVC_SYSROOT}/include/user")
+    set(MSVC_KERNEL_MODE_INCLUDE_DIRS "${MSVC_SYSROOT}/include/kernel")
+    set(MSVC_USER_MODE_LIB_DIRS "${MSVC_SYSROOT}/lib/user")
+    set(MSVC_KERNEL_MODE_LIB_DIRS "${MSVC_SYSROOT}/lib/kernel")
+
+    toolchain_log("INFO" "Using packed sysroot: ${MSVC_SYSROOT} (${MSVC_SYSROOT_LINK_MODE})")
+endif()
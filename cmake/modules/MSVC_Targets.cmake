@@ -4,23 +4,69 @@
 
 include(MSVC_Flags)
 include(MSVC_LTO)
+include(MSVC_PGO)
+
+# Write a per-symbol size report next to every kernel driver
+option(MSVC_DRIVER_SIZE_REPORT "Generate <driver>.map and <driver>.size.txt for kernel drivers" ON)
+
+# Directory of this module (for script-mode helpers)
+set(MSVC_TARGETS_MODULE_DIR "${CMAKE_CURRENT_LIST_DIR}")
 
 # Add common settings to a Windows target
+#
+# The settings are applied to the instrumented variant <target>_pgo_instr as
+# well, so the profile is collected from the same code that it optimizes.
 function(target_win_common target_name)
     cmake_parse_arguments(ARG "UNICODE" "RUNTIME" "" ${ARGN})
     
-    if(ARG_UNICODE)
-        target_compile_definitions(${target_name} PRIVATE UNICODE _UNICODE)
+    set(_targets ${target_name})
+    if(TARGET ${target_name}_pgo_instr)
+        list(APPEND _targets ${target_name}_pgo_instr)
     endif()
     
-    if(ARG_RUNTIME)
-        # Check if ARG_RUNTIME matches standard MSVC runtime flags
-        if(ARG_RUNTIME MATCHES "^(MT|MTd|MD|MDd)$")
-             target_compile_options(${target_name} PRIVATE "/${ARG_RUNTIME}")
-        else()
-             message(WARNING "Unknown runtime: ${ARG_RUNTIME} for target ${target_name}")
+    foreach(_target ${_targets})
+        if(ARG_UNICODE)
+            target_compile_definitions(${_target} PRIVATE UNICODE _UNICODE)
+        endif()
+        
+        if(ARG_RUNTIME)
+            # Check if ARG_RUNTIME matches standard MSVC runtime flags
+            if(ARG_RUNTIME MATCHES "^(MT|MTd|MD|MDd)$")
+                 target_compile_options(${_target} PRIVATE "/${ARG_RUNTIME}")
+            else()
+                 message(WARNING "Unknown runtime: ${ARG_RUNTIME} for target ${target_name}")
+            endif()
         endif()
+    endforeach()
+endfunction()
+
+# Internal helper to emit a map file and a per-symbol size report for a driver
+#
+# The lld map (/lldmap) lists every input section with its size; with /Gy or
+# -function-sections that is one entry per function or data object. The report
+# is written to <target>.size.txt after each link, so it can be archived and
+# diffed to track the footprint of the image.
+function(_add_driver_size_report target_name)
+    if(NOT MSVC_DRIVER_SIZE_REPORT)
+        return()
     endif()
+
+    set(_map "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.map")
+    set(_report "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.size.txt")
+
+    target_link_options(${target_name} PRIVATE "/lldmap:${_map}")
+
+    add_custom_command(TARGET ${target_name}
+        POST_BUILD
+        COMMAND ${CMAKE_COMMAND}
+            "-DMAP_FILE=${_map}"
+            "-DREPORT_FILE=${_report}"
+            "-DIMAGE_FILE=$<TARGET_FILE:${target_name}>"
+            -P "${MSVC_TARGETS_MODULE_DIR}/MSVC_SizeReport.cmake"
+        BYPRODUCTS "${_map}" "${_report}"
+        COMMENT "Writing size report for ${target_name}"
+        VERBATIM
+    )
 endfunction()
 
 # -----------------------------------------------------------------------------
@@ -34,8 +80,9 @@ function(add_win_executable target_name)
         return()
     endif()
 
-    cmake_parse_arguments(ARG "CONSOLE;GUI" "" "SOURCES;LIBS" ${ARGN})
+    cmake_parse_arguments(ARG "CONSOLE;GUI;PGO_INSTRUMENT" "PROFILE_KIND" "SOURCES;LIBS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
+    _pgo_check_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
 
     add_executable(${target_name} ${_sources})
     
@@ -54,11 +101,14 @@ function(add_win_executable target_name)
     
     # Init flags just in case (though CMake init handles this mostly)
     # We rely on compile options above for strictness
+    
+    # Profile-guided optimization
+    _pgo_setup_target(${target_name} "${_sources}" "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
 endfunction()
 
 # Add a standard Windows Library (User Mode - Static or Shared)
 function(add_win_library target_name)
-    cmake_parse_arguments(ARG "SHARED;STATIC" "DEF_FILE" "SOURCES;LIBS;EXPORTS" ${ARGN})
+    cmake_parse_arguments(ARG "SHARED;STATIC;PGO_INSTRUMENT" "DEF_FILE;PROFILE_KIND" "SOURCES;LIBS;EXPORTS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
 
     set(_lib_type "")
@@ -73,6 +123,8 @@ function(add_win_library target_name)
         return()
     endif()
     
+    _pgo_check_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
+    
     # Handle DEF_FILE for standard build (add to sources)
     if(ARG_DEF_FILE)
         list(APPEND _sources "${ARG_DEF_FILE}")
@@ -101,6 +153,9 @@ function(add_win_library target_name)
     if(ARG_LIBS)
         target_link_libraries(${target_name} PRIVATE ${ARG_LIBS})
     endif()
+    
+    # Profile-guided optimization
+    _pgo_setup_target(${target_name} "${_sources}" "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
 endfunction()
 
 # Wrapper for DLL
@@ -120,8 +175,9 @@ function(add_win_driver target_name)
         return()
     endif()
 
-    cmake_parse_arguments(ARG "KMDF;WDM" "" "SOURCES;LIBS" ${ARGN})
+    cmake_parse_arguments(ARG "KMDF;WDM;PGO_INSTRUMENT" "PROFILE_KIND" "SOURCES;LIBS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
+    _pgo_check_driver_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
 
     add_executable(${target_name} ${_sources})
     
@@ -149,6 +205,11 @@ function(add_win_driver target_name)
         ${MSVC_KERNEL_MODE_LIBS}
         ${ARG_LIBS}
     )
+    
+    # Profile-guided optimization (profile use only)
+    _pgo_setup_target(${target_name} "${_sources}" FALSE "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
+    
+    _add_driver_size_report(${target_name})
 endfunction()
 
 # -----------------------------------------------------------------------------
@@ -233,20 +294,65 @@ function(_link_lto_binary target_name output_suffix link_flags obj_files lib_fil
     endif()
 endfunction()
 
+# Internal helper to build the instrumented variant <target>_pgo_instr of an LTO target
+#
+# The variant reuses the bitcode of the target and only differs in the opt
+# stage (IR-level instrumentation) and the linked profile runtime.
+#
+# Parameters:
+#   target_name: Name of the target
+#   bc_files: List of bitcode files of the target
+#   opt_passes: Optimization passes of the target
+#   asm_objs: List of object files generated from ASM sources
+#   link_flags: Linker flags
+#   lib_files: List of libraries to link
+#   link_type: EXE or DLL
+#
+function(_link_lto_pgo_variant target_name bc_files opt_passes asm_objs link_flags lib_files link_type)
+    set(_variant "${target_name}_pgo_instr")
+    
+    _pgo_lto_flags(TRUE "" "" _pgo_compile_flags _pgo_opt_flags)
+    _lto_merge_and_optimize(${_variant} "${bc_files}" "${opt_passes}" _lto_obj PGO_FLAGS ${_pgo_opt_flags})
+    
+    _pgo_runtime_libs(_runtime_libs)
+    set(_libs ${lib_files} ${_runtime_libs})
+    set(_all_objs ${_lto_obj} ${asm_objs})
+    
+    if(link_type STREQUAL "DLL")
+        set(_output "${CMAKE_CURRENT_BINARY_DIR}/${_variant}.dll")
+    else()
+        set(_output "${CMAKE_CURRENT_BINARY_DIR}/${_variant}.exe")
+    endif()
+    
+    _link_lto_binary(${_variant} "${_output}" "${link_flags}" "${_all_objs}" "${_libs}" "${link_type}")
+    
+    # The shared bitcode is built by the target's own object chain
+    add_dependencies(${_variant}_lto_objs ${target_name}_lto_objs)
+endfunction()
+
 
 function(add_win_executable_lto target_name)
     _check_lto_available()
-    cmake_parse_arguments(ARG "CONSOLE;GUI" "OPT_PASSES" "SOURCES;LIBS" ${ARGN})
+    cmake_parse_arguments(ARG "CONSOLE;GUI;PGO_INSTRUMENT" "OPT_PASSES;PROFILE_KIND" "SOURCES;LIBS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
+    _pgo_check_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
+    _pgo_check_lto_passes(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_OPT_PASSES}")
+    
+    # Profile-guided optimization
+    _pgo_resolve_profile(${target_name} "${ARG_PROFILE}" "${ARG_PROFILE_KIND}" _profile)
+    _pgo_lto_flags(FALSE "${_profile}" "${ARG_PROFILE_KIND}" _pgo_compile_flags _pgo_opt_flags)
     
     # Flags
-    set(_compile_flags ${MSVC_COMMON_COMPILE_FLAGS_LTO} ${MSVC_USER_MODE_INCLUDES_LTO})
+    set(_compile_flags ${MSVC_COMMON_COMPILE_FLAGS_LTO} ${MSVC_USER_MODE_INCLUDES_LTO} ${_pgo_compile_flags})
     
     # Compile
     _compile_sources_to_bitcode(${target_name} "${_sources}" "${_compile_flags}" _bc_files _asm_objs)
     
     # Optimize & CodeGen (Manual LTO step)
-    _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj)
+    _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj
+        PGO_FLAGS ${_pgo_opt_flags}
+        PGO_DEPENDS ${_profile}
+    )
     
     # Link
     set(_output_exe "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.exe")
@@ -262,22 +368,45 @@ function(add_win_executable_lto target_name)
     set(_all_objs ${_lto_obj} ${_asm_objs})
     
     _link_lto_binary(${target_name} "${_output_exe}" "${_link_flags}" "${_all_objs}" "${_libs}" "EXE")
+    
+    if(ARG_PGO_INSTRUMENT)
+        _link_lto_pgo_variant(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" "${_asm_objs}" "${_link_flags}" "${_libs}" "EXE")
+    endif()
 endfunction()
 
 
 function(add_win_library_lto target_name)
     _check_lto_available()
-    cmake_parse_arguments(ARG "SHARED;STATIC" "OPT_PASSES;DEF_FILE" "SOURCES;LIBS;EXPORTS" ${ARGN})
+    cmake_parse_arguments(ARG "SHARED;STATIC;PGO_INSTRUMENT" "OPT_PASSES;DEF_FILE;PROFILE_KIND" "SOURCES;LIBS;EXPORTS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
+    _pgo_check_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
     
-    set(_compile_flags ${MSVC_COMMON_COMPILE_FLAGS_LTO} ${MSVC_USER_MODE_INCLUDES_LTO})
+    # Profile-guided optimization (only applies to DLLs, static libraries are
+    # optimized by their consumers)
+    if(ARG_SHARED)
+        _pgo_check_lto_passes(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_OPT_PASSES}")
+        _pgo_resolve_profile(${target_name} "${ARG_PROFILE}" "${ARG_PROFILE_KIND}" _profile)
+        _pgo_lto_flags(FALSE "${_profile}" "${ARG_PROFILE_KIND}" _pgo_compile_flags _pgo_opt_flags)
+    else()
+        if(ARG_PGO_INSTRUMENT OR ARG_PROFILE)
+            toolchain_log("WARNING" "PGO arguments are ignored for LTO static library ${target_name}; its bitcode is optimized by the consuming target")
+        endif()
+        set(_profile "")
+        set(_pgo_compile_flags "")
+        set(_pgo_opt_flags "")
+    endif()
+    
+    set(_compile_flags ${MSVC_COMMON_COMPILE_FLAGS_LTO} ${MSVC_USER_MODE_INCLUDES_LTO} ${_pgo_compile_flags})
     
     # Compile
     _compile_sources_to_bitcode(${target_name} "${_sources}" "${_compile_flags}" _bc_files _asm_objs)
     
     if(ARG_SHARED)
         # DLL Logic: Optimize -> Object -> Link
-        _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj)
+        _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj
+            PGO_FLAGS ${_pgo_opt_flags}
+            PGO_DEPENDS ${_profile}
+        )
         
         set(_output_dll "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.dll")
         set(_link_flags ${MSVC_USER_MODE_LINK_PATHS})
@@ -301,22 +430,37 @@ function(add_win_library_lto target_name)
         set(_all_objs ${_lto_obj} ${_asm_objs})
         _link_lto_binary(${target_name} "${_output_dll}" "${_link_flags}" "${_all_objs}" "${_libs}" "DLL")
         
+        if(ARG_PGO_INSTRUMENT)
+            _link_lto_pgo_variant(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" "${_asm_objs}" "${_link_flags}" "${_libs}" "DLL")
+        endif()
+        
     else()
         # STATIC Logic: Archive bitcode + ASM objects
-        # This allows standard LTO usage by consumers
-        set(_output_lib "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.lib")
+        # This allows standard LTO usage by consumers. Like the linked LTO
+        # targets, the archive is a real STATIC library built from IMPORTED
+        # objects, so usage requirements (target_include_directories,
+        # target_win_common, target_link_libraries) work on it and reach the
+        # bitcode compiles (see _compile_sources_to_bitcode).
         set(_archive_inputs ${_bc_files} ${_asm_objs})
+        set(_obj_target "${target_name}_lto_objs")
+        add_custom_target(${_obj_target} DEPENDS ${_archive_inputs})
         
-        add_custom_command(
-            OUTPUT "${_output_lib}"
-            COMMAND ${CMAKE_AR} 
-                "/OUT:${_output_lib}"
-                ${_archive_inputs}
-            DEPENDS ${_archive_inputs}
-            COMMENT "Creating LTO static library ${target_name}"
-            VERBATIM
+        set(_imported_objs "${target_name}_imported_objs")
+        add_library(${_imported_objs} OBJECT IMPORTED)
+        set_target_properties(${_imported_objs} PROPERTIES
+            IMPORTED_OBJECTS "${_archive_inputs}"
+        )
+        
+        add_library(${target_name} STATIC $<TARGET_OBJECTS:${_imported_objs}>)
+        set_target_properties(${target_name} PROPERTIES
+            PREFIX ""
+            LINKER_LANGUAGE CXX
         )
-        add_custom_target(${target_name} ALL DEPENDS "${_output_lib}")
+        add_dependencies(${target_name} ${_obj_target})
+        
+        if(ARG_LIBS)
+            target_link_libraries(${target_name} PRIVATE ${ARG_LIBS})
+        endif()
         
         # Backward compatibility: Property for merged bitcode
         if(_bc_files)
@@ -330,7 +474,7 @@ function(add_win_library_lto target_name)
              )
              set_target_properties(${target_name} PROPERTIES LTO_BITCODE_FILE "${_merged_bc}")
              # Ensure it builds
-             set_property(TARGET ${target_name} APPEND PROPERTY SOURCES "${_merged_bc}")
+             set_property(TARGET ${_obj_target} APPEND PROPERTY SOURCES "${_merged_bc}")
         endif()
     endif()
 endfunction()
@@ -338,14 +482,21 @@ endfunction()
 
 function(add_win_driver_lto target_name)
     _check_lto_available()
-    cmake_parse_arguments(ARG "KMDF;WDM" "OPT_PASSES" "SOURCES;LIBS" ${ARGN})
+    cmake_parse_arguments(ARG "KMDF;WDM;PGO_INSTRUMENT" "OPT_PASSES;PROFILE_KIND" "SOURCES;LIBS;PROFILE" ${ARGN})
     set(_sources ${ARG_SOURCES} ${ARG_UNPARSED_ARGUMENTS})
+    _pgo_check_driver_arguments(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_PROFILE_KIND}")
+    _pgo_check_lto_passes(${target_name} "${ARG_PGO_INSTRUMENT}" "${ARG_PROFILE}" "${ARG_OPT_PASSES}")
+    
+    # Profile-guided optimization (profile use only)
+    _pgo_resolve_profile(${target_name} "${ARG_PROFILE}" "${ARG_PROFILE_KIND}" _profile)
+    _pgo_lto_flags(FALSE "${_profile}" "${ARG_PROFILE_KIND}" _pgo_compile_flags _pgo_opt_flags)
     
     # Kernel Flags
     set(_compile_flags 
         ${MSVC_COMMON_COMPILE_FLAGS_LTO} 
         ${MSVC_KERNEL_MODE_INCLUDES_LTO}
         ${MSVC_KERNEL_MODE_COMPILE_OPTIONS}
+        ${_pgo_compile_flags}
     )
     # Add Defines explicitly to flags if needed? 
     # _compile_sources_to_bitcode accepts a single string list.
@@ -357,8 +508,12 @@ function(add_win_driver_lto target_name)
     # Compile
     _compile_sources_to_bitcode(${target_name} "${_sources}" "${_compile_flags}" _bc_files _asm_objs)
     
-    # Optimize & CodeGen
-    _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj)
+    # Optimize & CodeGen (per-function/data sections for /OPT:REF)
+    _lto_merge_and_optimize(${target_name} "${_bc_files}" "${ARG_OPT_PASSES}" _lto_obj
+        PGO_FLAGS ${_pgo_opt_flags}
+        PGO_DEPENDS ${_profile}
+        LLC_FLAGS ${MSVC_KERNEL_MODE_LLC_FLAGS}
+    )
     
     # Link
     set(_output_sys "${CMAKE_CURRENT_BINARY_DIR}/${target_name}.sys")
@@ -376,4 +531,6 @@ function(add_win_driver_lto target_name)
     set(_all_objs ${_lto_obj} ${_asm_objs})
     
     _link_lto_binary(${target_name} "${_output_sys}" "${_link_flags}" "${_all_objs}" "${_libs}" "SYS")
+    
+    _add_driver_size_report(${target_name})
 endfunction()
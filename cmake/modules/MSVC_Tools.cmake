@@ -74,6 +74,36 @@ endif()
 # Cache LTO availability
 set(LTO_TOOLS_AVAILABLE ${LTO_TOOLS_AVAILABLE} CACHE BOOL "Whether LTO tools are available" FORCE)
 
+# =============================================================================
+# Find PGO Tools (Optional)
+# =============================================================================
+# llvm-profdata merges raw/sample profiles; the profile runtime is linked into
+# instrumented binaries. Both are only required when PGO arguments are used.
+
+_find_msvc_tool("llvm-profdata" LLVM_PROFDATA_PATH)
+if(NOT LLVM_PROFDATA_PATH)
+    toolchain_log("INFO" "llvm-profdata not found, only single .profdata files can be used with PROFILE")
+endif()
+
+# Locate clang_rt.profile in the resource directory of clang-cl
+if(NOT PGO_PROFILE_RUNTIME)
+    execute_process(
+        COMMAND "${CLANG_CL_PATH}" /clang:-print-resource-dir
+        OUTPUT_VARIABLE _clang_resource_dir
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET
+    )
+    find_file(PGO_PROFILE_RUNTIME
+        NAMES clang_rt.profile-x86_64.lib clang_rt.profile.lib
+        PATHS "${_clang_resource_dir}/lib/windows" "${_clang_resource_dir}/lib/x86_64-pc-windows-msvc"
+        NO_DEFAULT_PATH
+        NO_CMAKE_FIND_ROOT_PATH
+    )
+endif()
+if(PGO_PROFILE_RUNTIME)
+    toolchain_log("INFO" "Found profile runtime: ${PGO_PROFILE_RUNTIME}")
+endif()
+
 # =============================================================================
 # Set Compilers and Tools
 # =============================================================================
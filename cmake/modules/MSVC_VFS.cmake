@@ -81,4 +81,10 @@ function(generate_vfsoverlay)
 endfunction()
 
 # Generate VFS overlay at configure time
-generate_vfsoverlay()
\ No newline at end of file
+# (a packed sysroot is already case-normalized, see MSVC_Sysroot)
+if(MSVC_SYSROOT)
+    set(VFSOVERLAY_FILE "")
+    toolchain_log("INFO" "Packed sysroot in use, skipping VFS overlay")
+else()
+    generate_vfsoverlay()
+endif()
\ No newline at end of file
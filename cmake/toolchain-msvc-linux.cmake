@@ -23,15 +23,19 @@ include(MSVC_Config)
 #    Sets: CMAKE_C_COMPILER, CMAKE_CXX_COMPILER, CMAKE_LINKER, etc.
 include(MSVC_Tools)
 
-# 4. VFS Overlay (Case-insensitivity support)
+# 4. Packed Sysroot (Optional single-root SDK image)
+#    Provides: msvc_sysroot target; with MSVC_SYSROOT set, replaces Include/Lib Paths
+include(MSVC_Sysroot)
+
+# 5. VFS Overlay (Case-insensitivity support)
 #    Generates: basic vfsoverlay.yaml for case-insensitive header mapping
 include(MSVC_VFS)
 
-# 5. Flags (Compiler/Linker definitions)
+# 6. Flags (Compiler/Linker definitions)
 #    Sets: CMAKE_C_FLAGS_INIT, CMAKE_CXX_FLAGS_INIT, and global compile definitions
 include(MSVC_Flags)
 
-# 6. Targets (add_win_executable, add_win_driver, etc.)
+# 7. Targets (add_win_executable, add_win_driver, etc.)
 #    Provides: add_win_executable, add_win_library, add_win_driver (and LTO variants)
 include(MSVC_Targets)
 
@@ -0,0 +1,422 @@
+/**
+ * @file mathlib_bench.cpp
+ * @brief Host-side correctness check and benchmark for the mathlib batch APIs
+ *
+ * The batch and sieve functions are checked against the existing scalar
+ * functions (and a 128-bit reference for modular exponentiation), then both
+ * are timed over the same inputs.
+ */
+
+#include "mathlib.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void fail(const char* what, unsigned long long a, unsigned long long b = 0, unsigned long long c = 0)
+{
+    if (g_failures++ < 20)
+    {
+        std::printf("FAIL: %s (%llu, %llu, %llu)\n", what, a, b, c);
+    }
+}
+
+/**
+ * @brief Reference (base ^ exp) mod mod using 128-bit remainders
+ */
+uint64_t powModReference(uint64_t base, uint64_t exp, uint64_t mod)
+{
+    if (mod <= 1) return 0;
+
+    unsigned __int128 result = 1;
+    unsigned __int128 b = base % mod;
+    while (exp > 0)
+    {
+        if (exp & 1) result = result * b % mod;
+        b = b * b % mod;
+        exp >>= 1;
+    }
+    return (uint64_t)result;
+}
+
+/**
+ * @brief Reference primality by trial division (for n < 2^42 or so)
+ */
+bool isPrimeReference(uint64_t n)
+{
+    if (n < 2) return false;
+    if (n % 2 == 0) return n == 2;
+    for (uint64_t d = 3; d * d <= n; d += 2)
+    {
+        if (n % d == 0) return false;
+    }
+    return true;
+}
+
+void checkPrimality(std::mt19937_64& rng)
+{
+    // Every int up to 2M against the scalar isPrime
+    for (int n = -10; n < 2000000; n++)
+    {
+        if (mathlib::isPrime64((uint64_t)(n < 0 ? 0 : n)) != mathlib::isPrime(n < 0 ? 0 : n)) fail("isPrime64 small", (unsigned long long)n);
+    }
+
+    // Random ints, through the batch API
+    std::vector<uint64_t> values(100000);
+    std::vector<bool> expected(values.size());
+    std::uniform_int_distribution<int> anyInt(0, INT_MAX);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        int n = anyInt(rng);
+        values[i] = (uint64_t)n;
+        expected[i] = mathlib::isPrime(n);
+    }
+    std::unique_ptr<bool[]> results(new bool[values.size()]);
+    mathlib::isPrimeBatch(values.data(), results.get(), values.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (results[i] != expected[i]) fail("isPrimeBatch", values[i]);
+    }
+
+    // Values beyond int, against trial division
+    std::uniform_int_distribution<uint64_t> wide(1ull << 31, 1ull << 40);
+    for (int i = 0; i < 2000; i++)
+    {
+        uint64_t n = wide(rng) | 1;
+        if (mathlib::isPrime64(n) != isPrimeReference(n)) fail("isPrime64 wide", n);
+    }
+
+    // Known 64-bit primes and strong pseudoprimes
+    const struct { uint64_t n; bool prime; } known[] = {
+        { 2305843009213693951ull, true },   // 2^61 - 1
+        { 18446744073709551557ull, true },  // Largest 64-bit prime
+        { 18446744073709551615ull, false }, // 2^64 - 1
+        { 4294967291ull, true },            // Largest 32-bit prime
+        { 4294967297ull, false },           // 2^32 + 1
+        { 561ull, false },                  // Carmichael numbers
+        { 41041ull, false },
+        { 825265ull, false },
+        { 3215031751ull, false },           // Strong pseudoprime to 2, 3, 5, 7
+        { 4759123141ull, false },           // Strong pseudoprime to 2, 7, 61
+        { 1122004669633ull, false },
+        { 3825123056546413051ull, false },  // Strong pseudoprime to bases up to 37
+        { 1000000000000000003ull, true },
+    };
+    for (const auto& entry : known)
+    {
+        if (mathlib::isPrime64(entry.n) != entry.prime) fail("isPrime64 known", entry.n);
+    }
+}
+
+void checkSieve(std::mt19937_64& rng)
+{
+    // Prefix counts against isPrime
+    const int limit = 2000000;
+    std::vector<uint32_t> prefix(limit + 1, 0);
+    for (int n = 0; n < limit; n++)
+    {
+        prefix[n + 1] = prefix[n] + (mathlib::isPrime(n) ? 1 : 0);
+    }
+
+    std::uniform_int_distribution<uint64_t> bound(0, limit);
+    for (int i = 0; i < 2000; i++)
+    {
+        uint64_t low = bound(rng);
+        uint64_t high = bound(rng);
+        if (low > high) std::swap(low, high);
+        if (mathlib::countPrimes(low, high) != prefix[high] - prefix[low]) fail("countPrimes", low, high);
+    }
+
+    // Small ranges around the start and segment boundaries
+    for (uint64_t base : { 0ull, 65536ull, 131072ull, 196608ull })
+    {
+        for (uint64_t low = base; low < base + 8; low++)
+        {
+            for (uint64_t high = low; high < base + 40; high++)
+            {
+                if (low >= 4 && high > limit) continue;
+                if (mathlib::countPrimes(low, high) != prefix[high] - prefix[low]) fail("countPrimes boundary", low, high);
+            }
+        }
+    }
+
+    if (mathlib::countPrimes(0, 100000000) != 5761455) fail("countPrimes pi(10^8)", 100000000);
+
+    // Generated primes far from zero, against Miller-Rabin
+    for (uint64_t low : { 1000000000000ull, (1ull << 40) - 500000, (unsigned long long)mathlib::kSieveLimit - 200000 })
+    {
+        uint64_t high = std::min(low + 1000000, mathlib::kSieveLimit);
+        uint64_t count = mathlib::countPrimes(low, high);
+        std::vector<uint64_t> primes(count);
+        if (mathlib::generatePrimes(low, high, primes.data(), primes.size()) != count) fail("generatePrimes count", low, high);
+
+        size_t next = 0;
+        for (uint64_t n = low; n < high; n++)
+        {
+            if (!mathlib::isPrime64(n)) continue;
+            if (next >= primes.size() || primes[next] != n) fail("generatePrimes", low, high, n);
+            next++;
+        }
+        if (next != primes.size()) fail("generatePrimes extra", low, high);
+    }
+
+    // Truncated output
+    uint64_t first[4] = { 0, 0, 0, 0 };
+    if (mathlib::generatePrimes(0, 100, first, 3) != 25) fail("generatePrimes total", 100);
+    if (first[0] != 2 || first[1] != 3 || first[2] != 5 || first[3] != 0) fail("generatePrimes capacity", first[2], first[3]);
+
+    // Ranges above the limit are rejected
+    if (mathlib::countPrimes(mathlib::kSieveLimit, mathlib::kSieveLimit + 100) != 0) fail("countPrimes above limit", mathlib::kSieveLimit);
+    if (mathlib::generatePrimes(0, UINT64_MAX, first, 4) != 0) fail("generatePrimes above limit", UINT64_MAX);
+}
+
+void checkGcdLcm(std::mt19937_64& rng)
+{
+    const size_t count = 200000;
+    std::vector<int> a(count), b(count), out(count);
+
+    std::uniform_int_distribution<int> anyInt(INT_MIN + 1, INT_MAX);
+    for (size_t i = 0; i < count; i++)
+    {
+        a[i] = i % 97 == 0 ? 0 : anyInt(rng);
+        b[i] = i % 89 == 0 ? 0 : anyInt(rng) >> (i % 24);
+    }
+    mathlib::gcdBatch(a.data(), b.data(), out.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (out[i] != mathlib::gcd(a[i], b[i])) fail("gcdBatch", (unsigned long long)a[i], (unsigned long long)b[i]);
+    }
+
+    // Small enough that the scalar lcm does not overflow
+    std::uniform_int_distribution<int> smallInt(-46340, 46340);
+    for (size_t i = 0; i < count; i++)
+    {
+        a[i] = smallInt(rng);
+        b[i] = smallInt(rng);
+    }
+    mathlib::lcmBatch(a.data(), b.data(), out.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (out[i] != mathlib::lcm(a[i], b[i])) fail("lcmBatch", (unsigned long long)a[i], (unsigned long long)b[i]);
+    }
+}
+
+void checkPowMod(std::mt19937_64& rng)
+{
+    // Against the scalar power where it does not overflow
+    for (int base = 0; base < 10; base++)
+    {
+        for (int exp = 0; exp < 19; exp++)
+        {
+            for (uint64_t mod : { 1ull, 2ull, 7ull, 64ull, 1000000007ull, 18446744073709551615ull })
+            {
+                if (mathlib::powMod(base, exp, mod) != (uint64_t)mathlib::power(base, exp) % mod) fail("powMod vs power", base, exp, mod);
+            }
+        }
+    }
+
+    // Odd, even and power-of-two moduli against the 128-bit reference
+    std::vector<uint64_t> mods = { 0, 1, 2, 3, 1ull << 63, (1ull << 63) + 1, 18446744073709551615ull, 18446744073709551557ull };
+    for (int i = 0; i < 200; i++)
+    {
+        uint64_t mod = rng() >> (i % 64);
+        mods.push_back(i % 3 == 0 ? mod & ~1ull : mod);
+    }
+
+    std::vector<uint64_t> bases(64), exps(64), out(64);
+    for (uint64_t mod : mods)
+    {
+        for (size_t i = 0; i < bases.size(); i++)
+        {
+            bases[i] = i < 4 ? i : rng();
+            exps[i] = i % 8 == 0 ? i / 8 : rng() >> (i % 64);
+        }
+        mathlib::powModBatch(bases.data(), exps.data(), mod, out.data(), bases.size());
+        for (size_t i = 0; i < bases.size(); i++)
+        {
+            uint64_t expected = powModReference(bases[i], exps[i], mod);
+            if (out[i] != expected) fail("powModBatch", bases[i], exps[i], mod);
+            if (mathlib::powMod(bases[i], exps[i], mod) != expected) fail("powMod", bases[i], exps[i], mod);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark
+// -----------------------------------------------------------------------------
+
+volatile uint64_t g_sink;
+
+/**
+ * @brief Run fn repeatedly for at least minSeconds, return seconds per run
+ */
+template <typename Fn>
+double measure(double minSeconds, Fn fn)
+{
+    using Clock = std::chrono::steady_clock;
+
+    size_t runs = 0;
+    auto begin = Clock::now();
+    double elapsed = 0.0;
+    do
+    {
+        fn();
+        runs++;
+        elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    } while (elapsed < minSeconds);
+    return elapsed / (double)runs;
+}
+
+void report(const char* name, size_t items, double scalarSeconds, double batchSeconds)
+{
+    std::printf("%-28s %10zu %12.2f %12.2f %8.1fx\n", name, items,
+        scalarSeconds * 1e9 / (double)items, batchSeconds * 1e9 / (double)items, scalarSeconds / batchSeconds);
+}
+
+void benchAll(double minSeconds)
+{
+    std::mt19937_64 rng(7);
+    std::printf("\n%-28s %10s %12s %12s %9s\n", "", "items", "scalar ns", "batch ns", "speedup");
+
+    // Primality of random ints
+    {
+        const size_t count = 100000;
+        std::vector<int> ints(count);
+        std::vector<uint64_t> values(count);
+        std::uniform_int_distribution<int> anyInt(0, INT_MAX);
+        for (size_t i = 0; i < count; i++)
+        {
+            ints[i] = anyInt(rng);
+            values[i] = (uint64_t)ints[i];
+        }
+        std::unique_ptr<bool[]> results(new bool[count]);
+
+        double scalar = measure(minSeconds, [&] {
+            uint64_t primes = 0;
+            for (int n : ints) primes += mathlib::isPrime(n);
+            g_sink = primes;
+        });
+        double batch = measure(minSeconds, [&] {
+            mathlib::isPrimeBatch(values.data(), results.get(), count);
+            g_sink = results[0];
+        });
+        report("isPrime (random int)", count, scalar, batch);
+    }
+
+    // Counting primes below N
+    {
+        const int limit = 10000000;
+        double scalar = measure(minSeconds, [&] {
+            uint64_t primes = 0;
+            for (int n = 0; n < limit; n++) primes += mathlib::isPrime(n);
+            g_sink = primes;
+        });
+        double batch = measure(minSeconds, [&] { g_sink = mathlib::countPrimes(0, limit); });
+        report("count primes < 10^7", limit, scalar, batch);
+    }
+
+    // Primes in a window far from zero (scalar: Miller-Rabin per value)
+    {
+        const uint64_t low = 1000000000000ull;
+        const uint64_t width = 1000000;
+        std::vector<uint64_t> primes(width);
+        double scalar = measure(minSeconds, [&] {
+            uint64_t count = 0;
+            for (uint64_t n = low; n < low + width; n++) count += mathlib::isPrime64(n);
+            g_sink = count;
+        });
+        double batch = measure(minSeconds, [&] { g_sink = mathlib::generatePrimes(low, low + width, primes.data(), primes.size()); });
+        report("primes in [10^12, +10^6)", width, scalar, batch);
+    }
+
+    // gcd / lcm of random pairs
+    {
+        const size_t count = 1000000;
+        std::vector<int> a(count), b(count), out(count);
+        std::uniform_int_distribution<int> anyInt(1, INT_MAX);
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = anyInt(rng);
+            b[i] = anyInt(rng);
+        }
+
+        double scalar = measure(minSeconds, [&] {
+            for (size_t i = 0; i < count; i++) out[i] = mathlib::gcd(a[i], b[i]);
+            g_sink = out[0];
+        });
+        double batch = measure(minSeconds, [&] {
+            mathlib::gcdBatch(a.data(), b.data(), out.data(), count);
+            g_sink = out[0];
+        });
+        report("gcd (random int pairs)", count, scalar, batch);
+
+        std::uniform_int_distribution<int> smallInt(1, 46340);
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = smallInt(rng);
+            b[i] = smallInt(rng);
+        }
+        scalar = measure(minSeconds, [&] {
+            for (size_t i = 0; i < count; i++) out[i] = mathlib::lcm(a[i], b[i]);
+            g_sink = out[0];
+        });
+        batch = measure(minSeconds, [&] {
+            mathlib::lcmBatch(a.data(), b.data(), out.data(), count);
+            g_sink = out[0];
+        });
+        report("lcm (random small pairs)", count, scalar, batch);
+    }
+
+    // Modular exponentiation (scalar: square-and-multiply with 128-bit remainders)
+    {
+        const size_t count = 100000;
+        const uint64_t mod = 18446744073709551557ull;
+        std::vector<uint64_t> bases(count), exps(count), out(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            bases[i] = rng();
+            exps[i] = rng();
+        }
+
+        double scalar = measure(minSeconds, [&] {
+            for (size_t i = 0; i < count; i++) out[i] = powModReference(bases[i], exps[i], mod);
+            g_sink = out[0];
+        });
+        double batch = measure(minSeconds, [&] {
+            mathlib::powModBatch(bases.data(), exps.data(), mod, out.data(), count);
+            g_sink = out[0];
+        });
+        report("powMod (64-bit modulus)", count, scalar, batch);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+
+    std::mt19937_64 rng(12345);
+    checkPrimality(rng);
+    checkSieve(rng);
+    checkGcdLcm(rng);
+    checkPowMod(rng);
+    if (g_failures)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("mathlib: all batch functions match the scalar results\n");
+
+    benchAll(quick ? 0.01 : 0.2);
+    return 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file stringlib_bench.cpp
+ * @brief Host-side correctness check and throughput benchmark for stringlib
+ *
+ * Every implementation supported by the CPU is checked against the scalar one
+ * (including strings that end right before an unmapped page), then the
+ * throughput of each function is measured across string lengths.
+ */
+
+#include "stringlib.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define BENCH_HAVE_MMAP 1
+#else
+#define BENCH_HAVE_MMAP 0
+#endif
+
+namespace {
+
+const stringlib::Impl kAllImpls[] = {
+    stringlib::Impl::Scalar,
+    stringlib::Impl::Word,
+    stringlib::Impl::SSE2,
+    stringlib::Impl::AVX2,
+};
+
+std::vector<stringlib::Impl> g_impls;
+int g_failures = 0;
+
+void fail(const char* what, stringlib::Impl impl, size_t len, size_t offset)
+{
+    if (g_failures++ < 20)
+    {
+        std::printf("FAIL: %s (%s, length %zu, offset %zu)\n", what, stringlib::implName(impl), len, offset);
+    }
+}
+
+int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * @brief Fill buf[0, len) with non-zero bytes and terminate it
+ */
+void fillString(char* buf, size_t len, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> byte(1, 255);
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (char)byte(rng);
+    }
+    buf[len] = '\0';
+}
+
+/**
+ * @brief Check one string of the given length at src (writable, terminated)
+ *
+ * The expected results come from the scalar implementation.
+ */
+void checkString(stringlib::Impl impl, char* src, size_t len, size_t offset, std::vector<char>& scratch)
+{
+    using stringlib::Impl;
+    using stringlib::setImpl;
+
+    setImpl(Impl::Scalar);
+    std::vector<char> reversed(src, src + len + 1);
+    stringlib::strrev(reversed.data());
+
+    setImpl(impl);
+
+    if ((size_t)stringlib::strlen(src) != len) fail("strlen", impl, len, offset);
+
+    // strcpy must not write past the terminator
+    scratch.assign(len + 64 + 64, '#');
+    char* dest = scratch.data() + 64 - offset % 64;
+    if (stringlib::strcpy(dest, src) != dest) fail("strcpy return value", impl, len, offset);
+    if (std::memcmp(dest, src, len + 1) != 0) fail("strcpy content", impl, len, offset);
+    if (dest[len + 1] != '#') fail("strcpy overrun", impl, len, offset);
+
+    if (stringlib::strcmp(src, dest) != 0) fail("strcmp equal", impl, len, offset);
+
+    // Differ at every position of short strings, a few of long ones
+    size_t step = len < 64 ? 1 : len / 31 + 1;
+    for (size_t i = 0; i < len; i += step)
+    {
+        char saved = dest[i];
+        for (int delta : { 1, -1 })
+        {
+            dest[i] = (char)(saved + delta);
+            setImpl(Impl::Scalar);
+            int expected = stringlib::strcmp(src, dest);
+            int expectedReverse = stringlib::strcmp(dest, src);
+            setImpl(impl);
+            if (stringlib::strcmp(src, dest) != expected) fail("strcmp differ", impl, len, offset);
+            if (stringlib::strcmp(dest, src) != expectedReverse) fail("strcmp differ (swapped)", impl, len, offset);
+        }
+
+        // Prefix: dest ends early
+        dest[i] = '\0';
+        if (sign(stringlib::strcmp(src, dest)) != 1) fail("strcmp prefix", impl, len, offset);
+        if (sign(stringlib::strcmp(dest, src)) != -1) fail("strcmp prefix (swapped)", impl, len, offset);
+        dest[i] = saved;
+    }
+
+    stringlib::strrev(dest);
+    if (std::memcmp(dest, reversed.data(), len + 1) != 0) fail("strrev", impl, len, offset);
+    if (dest[len + 1] != '#') fail("strrev overrun", impl, len, offset);
+}
+
+void checkNullHandling(stringlib::Impl impl)
+{
+    using stringlib::setImpl;
+    setImpl(impl);
+
+    char buf[4] = "abc";
+    if (stringlib::strlen(nullptr) != 0) fail("strlen(nullptr)", impl, 0, 0);
+    if (stringlib::strcpy(nullptr, buf) != nullptr) fail("strcpy(nullptr, src)", impl, 0, 0);
+    if (stringlib::strcpy(buf, nullptr) != buf) fail("strcpy(dest, nullptr)", impl, 0, 0);
+    if (stringlib::strcmp(nullptr, nullptr) != 0) fail("strcmp(nullptr, nullptr)", impl, 0, 0);
+    if (stringlib::strcmp(nullptr, buf) != -1) fail("strcmp(nullptr, str)", impl, 0, 0);
+    if (stringlib::strcmp(buf, nullptr) != 1) fail("strcmp(str, nullptr)", impl, 0, 0);
+    stringlib::strrev(nullptr);
+}
+
+void checkAll()
+{
+    std::mt19937 rng(12345);
+    std::vector<char> buf;
+    std::vector<char> scratch;
+
+    std::vector<size_t> lengths;
+    for (size_t len = 0; len <= 130; len++) lengths.push_back(len);
+    for (size_t len : { 255, 256, 257, 1000, 4095, 4096, 4097, 10000 }) lengths.push_back(len);
+
+    for (stringlib::Impl impl : g_impls)
+    {
+        checkNullHandling(impl);
+
+        for (size_t len : lengths)
+        {
+            for (size_t offset = 0; offset < 64; offset += (len < 300 ? 1 : 13))
+            {
+                buf.assign(offset + len + 1, 'x');
+                fillString(buf.data() + offset, len, rng);
+                checkString(impl, buf.data() + offset, len, offset, scratch);
+            }
+        }
+    }
+
+#if BENCH_HAVE_MMAP
+    // Strings that end right before an unmapped page: any load past the page
+    // of the terminator faults
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char* mapping = (char*)mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED || mprotect(mapping + page, page, PROT_NONE) != 0)
+    {
+        std::printf("warning: guard page unavailable, skipping page boundary checks\n");
+        return;
+    }
+
+    for (stringlib::Impl impl : g_impls)
+    {
+        for (size_t len = 0; len < 200; len++)
+        {
+            char* str = mapping + page - len - 1;
+            fillString(str, len, rng);
+            checkString(impl, str, len, (size_t)(page - len - 1), scratch);
+        }
+    }
+    munmap(mapping, 2 * page);
+#endif
+
+    stringlib::setImpl(stringlib::Impl::Scalar);
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark
+// -----------------------------------------------------------------------------
+
+volatile int g_sink;
+
+/**
+ * @brief Run op repeatedly for at least min_seconds and return MB/s
+ */
+template <typename Op>
+double measure(size_t bytesPerCall, double minSeconds, Op op)
+{
+    using Clock = std::chrono::steady_clock;
+
+    size_t calls = 0;
+    size_t batch = 16;
+    auto begin = Clock::now();
+    double elapsed = 0.0;
+    do
+    {
+        for (size_t i = 0; i < batch; i++) op();
+        calls += batch;
+        batch *= 2;
+        elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    } while (elapsed < minSeconds);
+
+    return (double)(bytesPerCall * calls) / elapsed / 1e6;
+}
+
+void benchAll(double minSeconds)
+{
+    using stringlib::Impl;
+    using stringlib::implName;
+    using stringlib::setImpl;
+
+    const size_t lengths[] = { 4, 16, 64, 256, 1024, 4096, 65536 };
+    const char* ops[] = { "strlen", "strcpy", "strcmp", "strrev" };
+
+    std::mt19937 rng(42);
+    std::vector<char> src(65536 + 64);
+    std::vector<char> dest(65536 + 64);
+    std::vector<char> other(65536 + 64);
+
+    for (const char* op : ops)
+    {
+        std::printf("\n%-8s %8s", op, "length");
+        for (Impl impl : g_impls) std::printf(" %10s", implName(impl));
+        std::printf("   (MB/s, best speedup vs scalar)\n");
+
+        for (size_t len : lengths)
+        {
+            // Unaligned start, as with strings taken out of a larger buffer
+            char* s = src.data() + 3;
+            fillString(s, len, rng);
+            std::memcpy(other.data() + 5, s, len + 1);
+            const char* o = other.data() + 5;
+            char* d = dest.data() + 1;
+
+            std::printf("%-8s %8zu", "", len);
+            double scalar = 0.0;
+            double best = 0.0;
+            for (Impl impl : g_impls)
+            {
+                setImpl(impl);
+                double mbps = 0.0;
+                if (std::strcmp(op, "strlen") == 0)
+                {
+                    mbps = measure(len + 1, minSeconds, [&] { g_sink = stringlib::strlen(s); });
+                }
+                else if (std::strcmp(op, "strcpy") == 0)
+                {
+                    mbps = measure(len + 1, minSeconds, [&] { g_sink = stringlib::strcpy(d, s)[0]; });
+                }
+                else if (std::strcmp(op, "strcmp") == 0)
+                {
+                    mbps = measure(len + 1, minSeconds, [&] { g_sink = stringlib::strcmp(s, o); });
+                }
+                else
+                {
+                    mbps = measure(len, minSeconds, [&] { stringlib::strrev(s); g_sink = s[0]; });
+                }
+
+                if (impl == Impl::Scalar) scalar = mbps;
+                if (mbps > best) best = mbps;
+                std::printf(" %10.0f", mbps);
+            }
+            std::printf("   x%.1f\n", scalar > 0.0 ? best / scalar : 0.0);
+        }
+    }
+
+    setImpl(Impl::Scalar);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+
+    stringlib::Impl selected = stringlib::getImpl();
+    for (stringlib::Impl impl : kAllImpls)
+    {
+        if (stringlib::setImpl(impl)) g_impls.push_back(impl);
+    }
+    stringlib::setImpl(selected);
+
+    std::printf("stringlib: selected at startup: %s, available:", stringlib::implName(selected));
+    for (stringlib::Impl impl : g_impls) std::printf(" %s", stringlib::implName(impl));
+    std::printf("\n");
+
+    checkAll();
+    if (g_failures)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("All implementations match the scalar results\n");
+
+    benchAll(quick ? 0.005 : 0.05);
+    return 0;
+}
@@ -5,6 +5,14 @@
 
 #include "mathlib.h"
 
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace mathlib {
 
 int gcd(int a, int b)
@@ -64,4 +72,486 @@ bool isPrime(int n)
     return true;
 }
 
+// -----------------------------------------------------------------------------
+// 64-bit helpers
+// -----------------------------------------------------------------------------
+// No 128-bit division is used anywhere, as clang-cl would emit calls to
+// compiler-rt helpers that the MSVC libraries do not provide.
+
+namespace {
+
+/**
+ * @brief 64x64 -> 128-bit multiplication, returns the low half
+ */
+inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t* high)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, high);
+#else
+    uint64_t aLow = (uint32_t)a, aHigh = a >> 32;
+    uint64_t bLow = (uint32_t)b, bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t middle = (lowLow >> 32) + (uint32_t)lowHigh + (uint32_t)highLow;
+    *high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return (middle << 32) | (uint32_t)lowLow;
+#endif
+}
+
+inline unsigned countTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (unsigned)index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)value)) return (unsigned)index;
+    _BitScanForward(&index, (unsigned long)(value >> 32));
+    return 32 + (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(value);
+#endif
+}
+
+/**
+ * @brief Inverse of an odd value modulo 2^64 (Newton iteration)
+ */
+inline uint64_t inverse64(uint64_t odd)
+{
+    uint64_t inverse = odd; // Correct to 3 bits
+    for (int i = 0; i < 5; i++)
+    {
+        inverse *= 2 - odd * inverse;
+    }
+    return inverse;
+}
+
+/**
+ * @brief Montgomery arithmetic modulo an odd n > 1
+ *
+ * Values are kept in Montgomery form (a * 2^64 mod n), so products are reduced
+ * with two multiplications instead of a division.
+ */
+class Montgomery
+{
+public:
+    explicit Montgomery(uint64_t mod)
+        : n_(mod), nInverse_(inverse64(mod)), one_((0 - mod) % mod), r2_(one_)
+    {
+        // 2^128 mod n, by doubling 2^64 mod n
+        for (int i = 0; i < 64; i++)
+        {
+            r2_ = add(r2_, r2_);
+        }
+    }
+
+    uint64_t one() const { return one_; }
+    uint64_t minusOne() const { return n_ - one_; }
+
+    uint64_t add(uint64_t a, uint64_t b) const
+    {
+        uint64_t sum = a + b;
+        if (sum < a || sum >= n_) sum -= n_;
+        return sum;
+    }
+
+    uint64_t multiply(uint64_t a, uint64_t b) const
+    {
+        uint64_t high;
+        uint64_t low = mul128(a, b, &high);
+        return reduce(high, low);
+    }
+
+    uint64_t toMontgomery(uint64_t a) const { return multiply(a % n_, r2_); }
+    uint64_t fromMontgomery(uint64_t a) const { return reduce(0, a); }
+
+    uint64_t power(uint64_t base, uint64_t exp) const
+    {
+        uint64_t result = one_;
+        while (exp > 0)
+        {
+            if (exp & 1) result = multiply(result, base);
+            base = multiply(base, base);
+            exp >>= 1;
+        }
+        return result;
+    }
+
+private:
+    // (high:low) * 2^-64 mod n, requires high < n
+    uint64_t reduce(uint64_t high, uint64_t low) const
+    {
+        uint64_t m = low * nInverse_;
+        uint64_t mnHigh;
+        mul128(m, n_, &mnHigh);
+        return high >= mnHigh ? high - mnHigh : high - mnHigh + n_;
+    }
+
+    uint64_t n_;
+    uint64_t nInverse_;
+    uint64_t one_;
+    uint64_t r2_;
+};
+
+/**
+ * @brief Modular exponentiation for one modulus, set up once per batch
+ *
+ * The modulus is split into 2^k * q with q odd. The odd part uses Montgomery
+ * arithmetic, the power-of-two part plain wrapping arithmetic, and the two
+ * results are combined with the CRT.
+ */
+class PowMod
+{
+public:
+    explicit PowMod(uint64_t mod)
+        : mod_(mod),
+          shift_(mod ? countTrailingZeros(mod) : 0),
+          odd_(mod >> shift_),
+          oddInverse_(inverse64(odd_)),
+          montgomery_(odd_ > 1 ? odd_ : 3)
+    {
+    }
+
+    uint64_t operator()(uint64_t base, uint64_t exp) const
+    {
+        if (mod_ <= 1) return 0;
+
+        uint64_t oddResult = 0;
+        if (odd_ > 1)
+        {
+            uint64_t b = montgomery_.toMontgomery(base);
+            oddResult = montgomery_.fromMontgomery(montgomery_.power(b, exp));
+        }
+        if (shift_ == 0) return oddResult;
+
+        // Power-of-two part: wrapping arithmetic keeps the low bits exact
+        uint64_t mask = ((uint64_t)1 << shift_) - 1;
+        uint64_t evenResult = 1;
+        uint64_t b = base;
+        while (exp > 0 && b & mask)
+        {
+            if (exp & 1) evenResult *= b;
+            b *= b;
+            exp >>= 1;
+        }
+        if (exp > 0) evenResult = 0; // b became a multiple of 2^k
+        evenResult &= mask;
+
+        // x = oddResult (mod q), x = evenResult (mod 2^k)
+        uint64_t t = ((evenResult - oddResult) * oddInverse_) & mask;
+        return oddResult + odd_ * t;
+    }
+
+private:
+    uint64_t mod_;
+    unsigned shift_;
+    uint64_t odd_;
+    uint64_t oddInverse_;
+    Montgomery montgomery_;
+};
+
+/**
+ * @brief Miller-Rabin round for an odd n > 2 written as n - 1 = d * 2^s
+ */
+bool millerRabinPasses(const Montgomery& mont, uint64_t n, uint64_t d, unsigned s, uint64_t witness)
+{
+    witness %= n;
+    if (witness == 0) return true;
+
+    uint64_t x = mont.power(mont.toMontgomery(witness), d);
+    if (x == mont.one() || x == mont.minusOne()) return true;
+
+    for (unsigned i = 1; i < s; i++)
+    {
+        x = mont.multiply(x, x);
+        if (x == mont.minusOne()) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Binary GCD of two magnitudes
+ *
+ * The shift amount of the next step is computed from the signed difference,
+ * in parallel with its absolute value, which keeps the loop-carried
+ * dependency short and the loop free of hard-to-predict branches.
+ */
+inline uint32_t binaryGcd(uint32_t a, uint32_t b)
+{
+    if (a == 0) return b;
+    if (b == 0) return a;
+
+    unsigned aZeros = countTrailingZeros(a);
+    unsigned bZeros = countTrailingZeros(b);
+    unsigned shift = aZeros < bZeros ? aZeros : bZeros;
+    a >>= aZeros;
+    b >>= bZeros;
+
+    while (a != 0)
+    {
+        int32_t difference = (int32_t)(a - b);
+        b = a < b ? a : b;
+        a = (uint32_t)(difference < 0 ? -difference : difference);
+        a >>= countTrailingZeros((uint32_t)difference | (a == 0 ? 0x80000000u : 0));
+    }
+    return b << shift;
+}
+
+inline uint32_t magnitude(int value)
+{
+    return value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+}
+
+// -----------------------------------------------------------------------------
+// Segmented sieve
+// -----------------------------------------------------------------------------
+
+// Odd numbers per segment (one byte each, sized for the L1 data cache)
+const size_t kSegmentOdds = 32 * 1024;
+
+uint64_t integerSqrt(uint64_t n)
+{
+    uint64_t root = (uint64_t)sqrt((double)n);
+    if (root > 0xFFFFFFFFull) root = 0xFFFFFFFFull;
+    while (root * root > n) root--;
+    while (root < 0xFFFFFFFFull && (root + 1) * (root + 1) <= n) root++;
+    return root;
+}
+
+template <typename SegmentFn>
+void sieveOddRange(uint64_t low, uint64_t high, SegmentFn onSegment);
+
+/**
+ * @brief Odd primes up to limit (inclusive)
+ *
+ * Small limits use a plain sieve; larger ones reuse the segmented sieve, so
+ * only the primes themselves are kept in memory, never a byte per odd number.
+ */
+std::vector<uint32_t> oddPrimesUpTo(uint32_t limit)
+{
+    std::vector<uint32_t> primes;
+    if (limit < 3) return primes;
+
+    if (limit / 2 >= kSegmentOdds)
+    {
+        sieveOddRange(3, (uint64_t)limit + 1, [&](const uint8_t* composite, size_t count, uint64_t first)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!composite[i]) primes.push_back((uint32_t)(first + 2 * (uint64_t)i));
+            }
+        });
+        return primes;
+    }
+
+    // composite[i] represents 2 * i + 1
+    std::vector<uint8_t> composite(limit / 2 + 1, 0);
+    for (uint64_t i = 1; i < composite.size(); i++)
+    {
+        if (composite[i]) continue;
+
+        uint64_t p = 2 * i + 1;
+        primes.push_back((uint32_t)p);
+        for (uint64_t j = p * p / 2; j < composite.size(); j += p)
+        {
+            composite[j] = 1;
+        }
+    }
+    return primes;
+}
+
+/**
+ * @brief Sieve the odd numbers >= 3 in [low, high) segment by segment
+ *
+ * onSegment(composite, count, first) is called for each segment, where
+ * composite[i] is zero if first + 2 * i is prime. The base primes up to
+ * sqrt(high) are generated once, so memory grows with pi(sqrt(high)), not
+ * with the size of the range. Callers keep high <= kSieveLimit.
+ */
+template <typename SegmentFn>
+void sieveOddRange(uint64_t low, uint64_t high, SegmentFn onSegment)
+{
+    uint64_t first = low < 3 ? 3 : (low | 1);
+    if (high == 0 || first > high - 1) return;
+
+    uint64_t last = high - 1;
+    std::vector<uint32_t> basePrimes = oddPrimesUpTo((uint32_t)integerSqrt(last));
+
+    // Index of the next odd multiple of each base prime, relative to the
+    // current segment (composites start at p * p)
+    std::vector<uint64_t> nextIndex(basePrimes.size());
+    for (size_t i = 0; i < basePrimes.size(); i++)
+    {
+        uint64_t p = basePrimes[i];
+        uint64_t start = p * p;
+        if (start < first)
+        {
+            uint64_t quotient = first / p + (first % p != 0);
+            quotient |= 1;
+            start = quotient > UINT64_MAX / p ? UINT64_MAX : quotient * p;
+        }
+        nextIndex[i] = start > last ? UINT64_MAX : (start - first) / 2;
+    }
+
+    std::vector<uint8_t> composite(kSegmentOdds);
+    uint64_t segmentFirst = first;
+    for (;;)
+    {
+        uint64_t remaining = (last - segmentFirst) / 2 + 1;
+        size_t count = remaining < kSegmentOdds ? (size_t)remaining : kSegmentOdds;
+
+        memset(composite.data(), 0, count);
+        for (size_t i = 0; i < basePrimes.size(); i++)
+        {
+            uint64_t index = nextIndex[i];
+            if (index >= count)
+            {
+                if (index != UINT64_MAX) nextIndex[i] = index - count;
+                continue;
+            }
+
+            uint32_t p = basePrimes[i];
+            for (; index < count; index += p)
+            {
+                composite[index] = 1;
+            }
+            nextIndex[i] = index - count;
+        }
+
+        onSegment(composite.data(), count, segmentFirst);
+
+        if (remaining <= kSegmentOdds) break;
+        segmentFirst += 2 * (uint64_t)kSegmentOdds;
+    }
+}
+
+} // namespace
+
+bool isPrime64(uint64_t n)
+{
+    static const uint32_t smallPrimes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+    if (n < 2) return false;
+    for (uint32_t p : smallPrimes)
+    {
+        if (n % p == 0) return n == p;
+    }
+    if (n < 41 * 41) return true;
+
+    uint64_t d = n - 1;
+    unsigned s = countTrailingZeros(d);
+    d >>= s;
+
+    Montgomery mont(n);
+
+    // Deterministic witness sets for 32-bit and 64-bit n
+    if (n < 0xFFFFFFFFull)
+    {
+        static const uint64_t witnesses32[] = { 2, 7, 61 };
+        for (uint64_t a : witnesses32)
+        {
+            if (!millerRabinPasses(mont, n, d, s, a)) return false;
+        }
+        return true;
+    }
+
+    static const uint64_t witnesses64[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+    for (uint64_t a : witnesses64)
+    {
+        if (!millerRabinPasses(mont, n, d, s, a)) return false;
+    }
+    return true;
+}
+
+void isPrimeBatch(const uint64_t* values, bool* results, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        results[i] = isPrime64(values[i]);
+    }
+}
+
+uint64_t countPrimes(uint64_t low, uint64_t high)
+{
+    if (high > kSieveLimit) return 0;
+
+    uint64_t total = (low <= 2 && high > 2) ? 1 : 0;
+
+    sieveOddRange(low, high, [&](const uint8_t* composite, size_t count, uint64_t)
+    {
+        size_t primes = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            primes += composite[i] == 0;
+        }
+        total += primes;
+    });
+    return total;
+}
+
+uint64_t generatePrimes(uint64_t low, uint64_t high, uint64_t* primes, size_t capacity)
+{
+    if (high > kSieveLimit) return 0;
+
+    uint64_t total = 0;
+    if (low <= 2 && high > 2)
+    {
+        if (total < capacity) primes[total] = 2;
+        total++;
+    }
+
+    sieveOddRange(low, high, [&](const uint8_t* composite, size_t count, uint64_t first)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (composite[i]) continue;
+            if (total < capacity) primes[total] = first + 2 * (uint64_t)i;
+            total++;
+        }
+    });
+    return total;
+}
+
+void gcdBatch(const int* a, const int* b, int* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = (int)binaryGcd(magnitude(a[i]), magnitude(b[i]));
+    }
+}
+
+void lcmBatch(const int* a, const int* b, int* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (a[i] == 0 || b[i] == 0)
+        {
+            out[i] = 0;
+            continue;
+        }
+        int g = (int)binaryGcd(magnitude(a[i]), magnitude(b[i]));
+        out[i] = (a[i] / g) * b[i];
+    }
+}
+
+uint64_t powMod(uint64_t base, uint64_t exp, uint64_t mod)
+{
+    return PowMod(mod)(base, exp);
+}
+
+void powModBatch(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t count)
+{
+    const PowMod powModN(mod);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = powModN(bases[i], exps[i]);
+    }
+}
+
 } // namespace mathlib
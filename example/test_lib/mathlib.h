@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 namespace mathlib {
 
 /**
@@ -27,4 +30,58 @@ long long power(int base, int exp);
  */
 bool isPrime(int n);
 
+/**
+ * @brief Check if a 64-bit value is prime (deterministic Miller-Rabin)
+ */
+bool isPrime64(uint64_t n);
+
+/**
+ * @brief Check an array of values for primality (results[i] = isPrime64(values[i]))
+ */
+void isPrimeBatch(const uint64_t* values, bool* results, size_t count);
+
+/**
+ * @brief Upper bound for high in countPrimes() / generatePrimes()
+ *
+ * The sieve keeps every prime up to sqrt(high) with its next multiple, about
+ * 13 MB at this bound.
+ */
+const uint64_t kSieveLimit = 1ull << 48;
+
+/**
+ * @brief Count the primes in [low, high) with a segmented sieve
+ *
+ * Returns 0 if high is larger than kSieveLimit.
+ */
+uint64_t countPrimes(uint64_t low, uint64_t high);
+
+/**
+ * @brief Generate the primes in [low, high) in ascending order with a segmented sieve
+ *
+ * At most capacity primes are written to primes. Returns the number of primes
+ * in the range, which may be larger than capacity, or 0 if high is larger
+ * than kSieveLimit.
+ */
+uint64_t generatePrimes(uint64_t low, uint64_t high, uint64_t* primes, size_t capacity);
+
+/**
+ * @brief Calculate GCD of pairs (out[i] = gcd(a[i], b[i])) with binary GCD
+ */
+void gcdBatch(const int* a, const int* b, int* out, size_t count);
+
+/**
+ * @brief Calculate LCM of pairs (out[i] = lcm(a[i], b[i]))
+ */
+void lcmBatch(const int* a, const int* b, int* out, size_t count);
+
+/**
+ * @brief Calculate (base ^ exp) mod mod (returns 0 if mod is 0)
+ */
+uint64_t powMod(uint64_t base, uint64_t exp, uint64_t mod);
+
+/**
+ * @brief Calculate out[i] = (bases[i] ^ exps[i]) mod mod for a shared modulus
+ */
+void powModBatch(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t count);
+
 } // namespace mathlib
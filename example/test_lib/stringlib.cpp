@@ -4,13 +4,28 @@
  */
 
 #include "stringlib.h"
+#include "stringlib_impl.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <atomic>
+
+#if STRINGLIB_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#elif STRINGLIB_X86
+#include <cpuid.h>
+#endif
 
 namespace stringlib {
+namespace detail {
 
-int strlen(const char* str)
+// -----------------------------------------------------------------------------
+// Scalar (byte-at-a-time) kernels
+// -----------------------------------------------------------------------------
+
+int strlenScalar(const char* str)
 {
-    if (str == nullptr) return 0;
-    
     int len = 0;
     while (*str++)
     {
@@ -19,11 +34,8 @@ int strlen(const char* str)
     return len;
 }
 
-char* strcpy(char* dest, const char* src)
+char* strcpyScalar(char* dest, const char* src)
 {
-    if (dest == nullptr) return nullptr;
-    if (src == nullptr) return dest;
-    
     char* ptr = dest;
     while ((*dest++ = *src++))
     {
@@ -32,12 +44,8 @@ char* strcpy(char* dest, const char* src)
     return ptr;
 }
 
-int strcmp(const char* str1, const char* str2)
+int strcmpScalar(const char* str1, const char* str2)
 {
-    if (str1 == nullptr && str2 == nullptr) return 0;
-    if (str1 == nullptr) return -1;
-    if (str2 == nullptr) return 1;
-    
     while (*str1 && (*str1 == *str2))
     {
         str1++;
@@ -46,16 +54,14 @@ int strcmp(const char* str1, const char* str2)
     return *(unsigned char*)str1 - *(unsigned char*)str2;
 }
 
-void strrev(char* str)
+void strrevScalar(char* str)
 {
-    if (str == nullptr) return;
-    
-    int len = strlen(str);
+    int len = strlenScalar(str);
     if (len <= 1) return;
-    
+
     char* start = str;
     char* end = str + len - 1;
-    
+
     while (start < end)
     {
         char temp = *start;
@@ -66,4 +72,335 @@ void strrev(char* str)
     }
 }
 
+// -----------------------------------------------------------------------------
+// Word-at-a-time (SWAR) kernels
+// -----------------------------------------------------------------------------
+// Each byte of a 64-bit word is tested at once. Byte indices are derived from
+// the lowest set bit, which assumes a little-endian target (x86, ARM).
+
+static inline uint64_t loadWord(const char* ptr)
+{
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+static inline void storeWord(char* ptr, uint64_t word)
+{
+    memcpy(ptr, &word, sizeof(word));
+}
+
+/**
+ * @brief Mark the zero bytes of a word with 0x80
+ *
+ * Bytes above the first zero byte may be marked spuriously (borrow), so only
+ * the lowest marker is meaningful.
+ */
+static inline uint64_t zeroBytes(uint64_t word)
+{
+    return (word - 0x0101010101010101ull) & ~word & 0x8080808080808080ull;
+}
+
+static inline uint64_t byteSwap(uint64_t word)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _byteswap_uint64(word);
+#else
+    return __builtin_bswap64(word);
+#endif
+}
+
+int strlenWord(const char* str)
+{
+    const char* ptr = str;
+
+    // Byte steps up to the first aligned word; aligned words never cross a page
+    while ((uintptr_t)ptr & (sizeof(uint64_t) - 1))
+    {
+        if (*ptr == '\0') return (int)(ptr - str);
+        ptr++;
+    }
+
+    for (;; ptr += sizeof(uint64_t))
+    {
+        uint64_t zero = zeroBytes(loadWord(ptr));
+        if (zero)
+        {
+            return (int)(ptr - str) + (int)(lowestBit64(zero) / 8);
+        }
+    }
+}
+
+char* strcpyWord(char* dest, const char* src)
+{
+    char* ptr = dest;
+
+    for (;;)
+    {
+        if (loadStaysInPage<sizeof(uint64_t)>(src))
+        {
+            uint64_t word = loadWord(src);
+            uint64_t zero = zeroBytes(word);
+            if (zero == 0)
+            {
+                storeWord(dest, word);
+                src += sizeof(uint64_t);
+                dest += sizeof(uint64_t);
+                continue;
+            }
+
+            // Copy the tail including the terminator
+            memcpy(dest, src, lowestBit64(zero) / 8 + 1);
+            return ptr;
+        }
+
+        if ((*dest++ = *src++) == '\0') return ptr;
+    }
+}
+
+int strcmpWord(const char* str1, const char* str2)
+{
+    for (;;)
+    {
+        if (loadStaysInPage<sizeof(uint64_t)>(str1) && loadStaysInPage<sizeof(uint64_t)>(str2))
+        {
+            uint64_t word1 = loadWord(str1);
+            uint64_t word2 = loadWord(str2);
+
+            // First byte that differs or ends str1
+            uint64_t stop = (word1 ^ word2) | zeroBytes(word1);
+            if (stop == 0)
+            {
+                str1 += sizeof(uint64_t);
+                str2 += sizeof(uint64_t);
+                continue;
+            }
+
+            unsigned index = lowestBit64(stop) / 8;
+            return (unsigned char)str1[index] - (unsigned char)str2[index];
+        }
+
+        unsigned char c1 = (unsigned char)*str1++;
+        unsigned char c2 = (unsigned char)*str2++;
+        if (c1 != c2 || c1 == '\0') return c1 - c2;
+    }
+}
+
+void strrevWord(char* str)
+{
+    char* start = str;
+    char* end = str + strlenWord(str);
+
+    // Swap byte-reversed words from both ends
+    while (end - start >= (ptrdiff_t)(2 * sizeof(uint64_t)))
+    {
+        end -= sizeof(uint64_t);
+        uint64_t head = loadWord(start);
+        uint64_t tail = loadWord(end);
+        storeWord(start, byteSwap(tail));
+        storeWord(end, byteSwap(head));
+        start += sizeof(uint64_t);
+    }
+
+    while (start + 1 < end)
+    {
+        end--;
+        char temp = *start;
+        *start = *end;
+        *end = temp;
+        start++;
+    }
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Dispatch
+// -----------------------------------------------------------------------------
+
+namespace {
+
+struct Kernels
+{
+    Impl impl;
+    int (*strlen)(const char*);
+    char* (*strcpy)(char*, const char*);
+    int (*strcmp)(const char*, const char*);
+    void (*strrev)(char*);
+};
+
+const Kernels kScalarKernels = {
+    Impl::Scalar, detail::strlenScalar, detail::strcpyScalar, detail::strcmpScalar, detail::strrevScalar
+};
+
+const Kernels kWordKernels = {
+    Impl::Word, detail::strlenWord, detail::strcpyWord, detail::strcmpWord, detail::strrevWord
+};
+
+#if STRINGLIB_X86
+const Kernels kSSE2Kernels = {
+    Impl::SSE2, detail::strlenSSE2, detail::strcpySSE2, detail::strcmpSSE2, detail::strrevSSE2
+};
+
+const Kernels kAVX2Kernels = {
+    Impl::AVX2, detail::strlenAVX2, detail::strcpyAVX2, detail::strcmpAVX2, detail::strrevAVX2
+};
+
+void cpuid(unsigned int regs[4], unsigned int leaf, unsigned int subleaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0 (states enabled by the OS), only valid if CPUID reports OSXSAVE
+uint64_t readXcr0()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+bool cpuHasSSE2()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#else
+    unsigned int regs[4];
+    cpuid(regs, 1, 0);
+    return (regs[3] & (1u << 26)) != 0;
+#endif
+}
+
+bool cpuHasAVX2()
+{
+    unsigned int regs[4];
+    cpuid(regs, 0, 0);
+    if (regs[0] < 7) return false;
+
+    // AVX and OSXSAVE, and the OS saves the XMM and YMM state
+    cpuid(regs, 1, 0);
+    const unsigned int osxsaveAvx = (1u << 27) | (1u << 28);
+    if ((regs[2] & osxsaveAvx) != osxsaveAvx) return false;
+    if ((readXcr0() & 0x6) != 0x6) return false;
+
+    cpuid(regs, 7, 0);
+    return (regs[1] & (1u << 5)) != 0;
+}
+#endif
+
+const Kernels* kernelsFor(Impl impl)
+{
+    switch (impl)
+    {
+    case Impl::Scalar:
+        return &kScalarKernels;
+    case Impl::Word:
+        return &kWordKernels;
+#if STRINGLIB_X86
+    case Impl::SSE2:
+        return cpuHasSSE2() ? &kSSE2Kernels : nullptr;
+    case Impl::AVX2:
+        return cpuHasAVX2() ? &kAVX2Kernels : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const Kernels* selectKernels()
+{
+    const Impl preferred[] = { Impl::AVX2, Impl::SSE2, Impl::Word };
+    for (Impl impl : preferred)
+    {
+        if (const Kernels* kernels = kernelsFor(impl)) return kernels;
+    }
+    return &kScalarKernels;
+}
+
+// Constant-initialized, so calls from other static initializers are safe.
+// Atomic because setImpl() may race with calls on other threads; every
+// kernel table is immutable, so relaxed ordering is enough.
+std::atomic<const Kernels*> g_kernels{ &kScalarKernels };
+
+const Kernels* activeKernels()
+{
+    return g_kernels.load(std::memory_order_relaxed);
+}
+
+// Select by CPUID once at startup
+struct KernelSelector
+{
+    KernelSelector() { g_kernels.store(selectKernels(), std::memory_order_relaxed); }
+} g_kernelSelector;
+
+} // namespace
+
+Impl getImpl()
+{
+    return activeKernels()->impl;
+}
+
+bool setImpl(Impl impl)
+{
+    const Kernels* kernels = kernelsFor(impl);
+    if (kernels == nullptr) return false;
+
+    g_kernels.store(kernels, std::memory_order_relaxed);
+    return true;
+}
+
+const char* implName(Impl impl)
+{
+    switch (impl)
+    {
+    case Impl::Scalar: return "scalar";
+    case Impl::Word: return "word";
+    case Impl::SSE2: return "sse2";
+    case Impl::AVX2: return "avx2";
+    default: return "unknown";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public functions
+// -----------------------------------------------------------------------------
+
+int strlen(const char* str)
+{
+    if (str == nullptr) return 0;
+
+    return activeKernels()->strlen(str);
+}
+
+char* strcpy(char* dest, const char* src)
+{
+    if (dest == nullptr) return nullptr;
+    if (src == nullptr) return dest;
+
+    return activeKernels()->strcpy(dest, src);
+}
+
+int strcmp(const char* str1, const char* str2)
+{
+    if (str1 == nullptr && str2 == nullptr) return 0;
+    if (str1 == nullptr) return -1;
+    if (str2 == nullptr) return 1;
+
+    return activeKernels()->strcmp(str1, str2);
+}
+
+void strrev(char* str)
+{
+    if (str == nullptr) return;
+
+    activeKernels()->strrev(str);
+}
+
 } // namespace stringlib
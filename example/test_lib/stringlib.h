@@ -27,4 +27,35 @@ int strcmp(const char* str1, const char* str2);
  */
 void strrev(char* str);
 
+/**
+ * @brief Implementations of the string functions
+ *
+ * The best implementation supported by the CPU is selected at startup.
+ */
+enum class Impl
+{
+    Scalar, ///< Byte-at-a-time loops
+    Word,   ///< Word-at-a-time (SWAR) scans
+    SSE2,   ///< 16-byte SIMD scans (x86 only)
+    AVX2,   ///< 32-byte SIMD scans (x86 only)
+};
+
+/**
+ * @brief Get the implementation currently in use
+ */
+Impl getImpl();
+
+/**
+ * @brief Switch the implementation (returns false if the CPU does not support it)
+ *
+ * Thread-safe: calls already running on other threads finish with the
+ * previous implementation.
+ */
+bool setImpl(Impl impl);
+
+/**
+ * @brief Get the name of an implementation
+ */
+const char* implName(Impl impl);
+
 } // namespace stringlib
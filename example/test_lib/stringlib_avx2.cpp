@@ -0,0 +1,171 @@
+/**
+ * @file stringlib_avx2.cpp
+ * @brief AVX2 kernels of the string processing library
+ *
+ * This file must be compiled with AVX2 enabled (/arch:AVX2 or -mavx2). The
+ * kernels are only called after the CPUID check in stringlib.cpp. Helpers
+ * shared with other files have internal linkage, so no AVX2 copy of an inline
+ * function can be picked by the linker for code outside this file.
+ */
+
+#include "stringlib_impl.h"
+
+#if STRINGLIB_X86
+
+#if !defined(__AVX2__)
+#error "stringlib_avx2.cpp must be compiled with AVX2 enabled (/arch:AVX2 or -mavx2)"
+#endif
+
+#include <immintrin.h>
+
+namespace stringlib {
+namespace detail {
+
+static const unsigned kBlock = 32;
+
+static inline uint32_t zeroMask(__m256i block)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_setzero_si256()));
+}
+
+/**
+ * @brief Reverse the 32 bytes of a vector
+ *
+ * Bytes are reversed within each 128-bit lane by a byte shuffle, then the two
+ * lanes are swapped.
+ */
+static inline __m256i reverseBytes(__m256i block)
+{
+    const __m256i laneReverse = _mm256_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    block = _mm256_shuffle_epi8(block, laneReverse);
+    return _mm256_permute4x64_epi64(block, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+/**
+ * @brief Reverse the 16 bytes of a vector
+ */
+static inline __m128i reverseBytes(__m128i block)
+{
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm_shuffle_epi8(block, reverse);
+}
+
+int strlenAVX2(const char* str)
+{
+    // Aligned loads never cross a page; bytes before str are masked off
+    uintptr_t offset = (uintptr_t)str & (kBlock - 1);
+    const char* block = str - offset;
+
+    uint32_t mask = zeroMask(_mm256_load_si256((const __m256i*)block)) >> offset;
+    if (mask) return (int)lowestBit(mask);
+
+    for (;;)
+    {
+        block += kBlock;
+        mask = zeroMask(_mm256_load_si256((const __m256i*)block));
+        if (mask) return (int)(block - str) + (int)lowestBit(mask);
+    }
+}
+
+char* strcpyAVX2(char* dest, const char* src)
+{
+    char* ptr = dest;
+
+    for (;;)
+    {
+        if (loadStaysInPage<kBlock>(src))
+        {
+            __m256i block = _mm256_loadu_si256((const __m256i*)src);
+            uint32_t mask = zeroMask(block);
+            if (mask == 0)
+            {
+                _mm256_storeu_si256((__m256i*)dest, block);
+                src += kBlock;
+                dest += kBlock;
+                continue;
+            }
+
+            // Copy the tail including the terminator
+            for (unsigned i = 0, count = lowestBit(mask) + 1; i < count; i++)
+            {
+                dest[i] = src[i];
+            }
+            return ptr;
+        }
+
+        if ((*dest++ = *src++) == '\0') return ptr;
+    }
+}
+
+int strcmpAVX2(const char* str1, const char* str2)
+{
+    for (;;)
+    {
+        if (loadStaysInPage<kBlock>(str1) && loadStaysInPage<kBlock>(str2))
+        {
+            __m256i block1 = _mm256_loadu_si256((const __m256i*)str1);
+            __m256i block2 = _mm256_loadu_si256((const __m256i*)str2);
+
+            // First byte that differs or ends str1
+            uint32_t differ = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2));
+            uint32_t stop = differ | zeroMask(block1);
+            if (stop == 0)
+            {
+                str1 += kBlock;
+                str2 += kBlock;
+                continue;
+            }
+
+            unsigned index = lowestBit(stop);
+            return (unsigned char)str1[index] - (unsigned char)str2[index];
+        }
+
+        unsigned char c1 = (unsigned char)*str1++;
+        unsigned char c2 = (unsigned char)*str2++;
+        if (c1 != c2 || c1 == '\0') return c1 - c2;
+    }
+}
+
+void strrevAVX2(char* str)
+{
+    char* start = str;
+    char* end = str + strlenAVX2(str);
+
+    // Swap byte-reversed blocks from both ends
+    while (end - start >= (intptr_t)(2 * kBlock))
+    {
+        end -= kBlock;
+        __m256i head = _mm256_loadu_si256((const __m256i*)start);
+        __m256i tail = _mm256_loadu_si256((const __m256i*)end);
+        _mm256_storeu_si256((__m256i*)start, reverseBytes(tail));
+        _mm256_storeu_si256((__m256i*)end, reverseBytes(head));
+        start += kBlock;
+    }
+
+    // Remaining middle part of up to 63 bytes
+    while (end - start >= (intptr_t)(2 * sizeof(__m128i)))
+    {
+        end -= sizeof(__m128i);
+        __m128i head = _mm_loadu_si128((const __m128i*)start);
+        __m128i tail = _mm_loadu_si128((const __m128i*)end);
+        _mm_storeu_si128((__m128i*)start, reverseBytes(tail));
+        _mm_storeu_si128((__m128i*)end, reverseBytes(head));
+        start += sizeof(__m128i);
+    }
+
+    while (start + 1 < end)
+    {
+        end--;
+        char temp = *start;
+        *start = *end;
+        *end = temp;
+        start++;
+    }
+}
+
+} // namespace detail
+} // namespace stringlib
+
+#endif // STRINGLIB_X86
@@ -0,0 +1,97 @@
+/**
+ * @file stringlib_impl.h
+ * @brief Internal kernels of the string processing library
+ *
+ * Kernels expect valid (non-null) pointers; null handling is done by the
+ * public functions in stringlib.cpp.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STRINGLIB_X86 1
+#else
+#define STRINGLIB_X86 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace stringlib {
+namespace detail {
+
+int strlenScalar(const char* str);
+char* strcpyScalar(char* dest, const char* src);
+int strcmpScalar(const char* str1, const char* str2);
+void strrevScalar(char* str);
+
+int strlenWord(const char* str);
+char* strcpyWord(char* dest, const char* src);
+int strcmpWord(const char* str1, const char* str2);
+void strrevWord(char* str);
+
+#if STRINGLIB_X86
+int strlenSSE2(const char* str);
+char* strcpySSE2(char* dest, const char* src);
+int strcmpSSE2(const char* str1, const char* str2);
+void strrevSSE2(char* str);
+
+int strlenAVX2(const char* str);
+char* strcpyAVX2(char* dest, const char* src);
+int strcmpAVX2(const char* str1, const char* str2);
+void strrevAVX2(char* str);
+#endif
+
+/**
+ * @brief Smallest page size of the supported targets
+ *
+ * Aligned loads never cross a page, so they may read past the terminator.
+ * Unaligned loads of N bytes are only used when they stay within the page.
+ */
+constexpr uintptr_t kPageSize = 4096;
+
+/**
+ * @brief Check whether an N-byte load at ptr stays within one page
+ */
+template <unsigned N>
+static inline bool loadStaysInPage(const void* ptr)
+{
+    return ((uintptr_t)ptr & (kPageSize - 1)) <= kPageSize - N;
+}
+
+/**
+ * @brief Index of the lowest set bit (mask must not be zero)
+ */
+static inline unsigned lowestBit(uint32_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Index of the lowest set bit of a 64-bit mask (mask must not be zero)
+ */
+static inline unsigned lowestBit64(uint64_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned)index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    uint32_t low = (uint32_t)mask;
+    return low ? lowestBit(low) : 32 + lowestBit((uint32_t)(mask >> 32));
+#else
+    return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+} // namespace detail
+} // namespace stringlib
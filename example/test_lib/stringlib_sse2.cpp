@@ -0,0 +1,143 @@
+/**
+ * @file stringlib_sse2.cpp
+ * @brief SSE2 kernels of the string processing library
+ *
+ * SSE2 is part of the x64 baseline, so no extra compile flags are needed.
+ */
+
+#include "stringlib_impl.h"
+
+#if STRINGLIB_X86
+
+#include <emmintrin.h>
+
+namespace stringlib {
+namespace detail {
+
+static const unsigned kBlock = 16;
+
+static inline uint32_t zeroMask(__m128i block)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_setzero_si128()));
+}
+
+/**
+ * @brief Reverse the 16 bytes of a vector
+ *
+ * SSE2 has no byte shuffle, so bytes are swapped within each word first and
+ * the words are then reversed with the word and dword shuffles.
+ */
+static inline __m128i reverseBytes(__m128i block)
+{
+    block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+    block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(0, 1, 2, 3));
+    block = _mm_shufflehi_epi16(block, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shuffle_epi32(block, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+int strlenSSE2(const char* str)
+{
+    // Aligned loads never cross a page; bytes before str are masked off
+    uintptr_t offset = (uintptr_t)str & (kBlock - 1);
+    const char* block = str - offset;
+
+    uint32_t mask = zeroMask(_mm_load_si128((const __m128i*)block)) >> offset;
+    if (mask) return (int)lowestBit(mask);
+
+    for (;;)
+    {
+        block += kBlock;
+        mask = zeroMask(_mm_load_si128((const __m128i*)block));
+        if (mask) return (int)(block - str) + (int)lowestBit(mask);
+    }
+}
+
+char* strcpySSE2(char* dest, const char* src)
+{
+    char* ptr = dest;
+
+    for (;;)
+    {
+        if (loadStaysInPage<kBlock>(src))
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)src);
+            uint32_t mask = zeroMask(block);
+            if (mask == 0)
+            {
+                _mm_storeu_si128((__m128i*)dest, block);
+                src += kBlock;
+                dest += kBlock;
+                continue;
+            }
+
+            // Copy the tail including the terminator
+            for (unsigned i = 0, count = lowestBit(mask) + 1; i < count; i++)
+            {
+                dest[i] = src[i];
+            }
+            return ptr;
+        }
+
+        if ((*dest++ = *src++) == '\0') return ptr;
+    }
+}
+
+int strcmpSSE2(const char* str1, const char* str2)
+{
+    for (;;)
+    {
+        if (loadStaysInPage<kBlock>(str1) && loadStaysInPage<kBlock>(str2))
+        {
+            __m128i block1 = _mm_loadu_si128((const __m128i*)str1);
+            __m128i block2 = _mm_loadu_si128((const __m128i*)str2);
+
+            // First byte that differs or ends str1
+            uint32_t differ = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) & 0xFFFF;
+            uint32_t stop = differ | zeroMask(block1);
+            if (stop == 0)
+            {
+                str1 += kBlock;
+                str2 += kBlock;
+                continue;
+            }
+
+            unsigned index = lowestBit(stop);
+            return (unsigned char)str1[index] - (unsigned char)str2[index];
+        }
+
+        unsigned char c1 = (unsigned char)*str1++;
+        unsigned char c2 = (unsigned char)*str2++;
+        if (c1 != c2 || c1 == '\0') return c1 - c2;
+    }
+}
+
+void strrevSSE2(char* str)
+{
+    char* start = str;
+    char* end = str + strlenSSE2(str);
+
+    // Swap byte-reversed blocks from both ends
+    while (end - start >= (intptr_t)(2 * kBlock))
+    {
+        end -= kBlock;
+        __m128i head = _mm_loadu_si128((const __m128i*)start);
+        __m128i tail = _mm_loadu_si128((const __m128i*)end);
+        _mm_storeu_si128((__m128i*)start, reverseBytes(tail));
+        _mm_storeu_si128((__m128i*)end, reverseBytes(head));
+        start += kBlock;
+    }
+
+    while (start + 1 < end)
+    {
+        end--;
+        char temp = *start;
+        *start = *end;
+        *end = temp;
+        start++;
+    }
+}
+
+} // namespace detail
+} // namespace stringlib
+
+#endif // STRINGLIB_X86